@@ -6,461 +6,2591 @@
 #include <thread>
 #include <random>
 #include <limits>
+#include <cstdlib>
+#include <numeric>
+#include <stdexcept>
+#include <algorithm>
+#include <utility>
 #include <boost/range/irange.hpp>
 #include <Eigen/Dense>
 #include "GPs.h"
 
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#endif
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#ifdef GP_USE_LAPACKE
+#include <lapacke.h>
+#include <cblas.h>
+#endif
+
+#ifdef GP_USE_CPPOPTLIB
+#include "./include/cppoptlib/meta.h"
+#include "./include/cppoptlib/boundedproblem.h"
+#include "./include/cppoptlib/solver/lbfgsbsolver.h"
+#endif
+
+#if defined(__GNUC__) && ( defined(__x86_64__) || defined(__i386__) )
+#include <immintrin.h>
+#define GP_X86_DISPATCH
+#endif
+
 // Retrieve aliases from GP namescope
 using Matrix = GP::Matrix;
 using Vector = GP::Vector;
 
 
-// Compute pairwise distance between lists of points
-void GP::pdist(Matrix & Dv, Matrix & X1, Matrix & X2)
+//
+//   [ Thread Pool ]
+//
+
+// Index of the pool worker running on the current thread [ -1 for threads outside the pool ]
+static thread_local int workerIndex = -1;
+
+// Width of parallel loops started on the current thread [ 0 = whole pool ]
+static thread_local int loopWidth = 0;
+
+// Get/set the flush-to-zero and denormals-are-zero bits of the SSE control register
+// [ Loops and task graphs run their helpers in the mode of the calling thread ]
+static const unsigned DENORMAL_FLUSH = 0x8040u;
+static unsigned getDenormalMode()
 {
-  auto n = static_cast<int>(X1.rows());
-  auto entryCount = static_cast<int>( (n*(n-1))/2);
-  Dv.resize(entryCount, 1);
+#ifdef GP_X86_DISPATCH
+  return _mm_getcsr() & DENORMAL_FLUSH;
+#else
+  return 0;
+#endif
+}
 
-  // Get thread count
-  int threadCount = Eigen::nbThreads( );
-      
-  // Get problem dimension d per thread
-  auto d = static_cast<int>(n/threadCount);
-  
-  std::vector<int> startVals;
-  for ( auto i : boost::irange(0,threadCount) )
-    startVals.emplace_back(i*d);
-
-  std::vector<int> endVals;
-  for ( auto i : boost::irange(1,threadCount) )
-    endVals.emplace_back(i*d);
-  endVals.emplace_back(n-1);
-
-  // Define lambda function specifying each threads solver task
-  auto lambda = [&Dv,&X1,&X2,n](int startInd, int endInd) {
-                  for ( auto i : boost::irange(startInd, endInd) )
-                    {      
-                      for ( auto j : boost::irange(i+1,n) )
-                        Dv(static_cast<int>(i*n-(i*(i+1))/2+j-i-1), 0) = (static_cast<Vector>(X1.row(i)-X2.row(j))).squaredNorm();
-                    }
-                };
+static void setDenormalMode(unsigned mode)
+{
+#ifdef GP_X86_DISPATCH
+  _mm_setcsr( (_mm_getcsr() & ~DENORMAL_FLUSH) | mode );
+#else
+  (void)mode;
+#endif
+}
 
-  // Initialize thread list
-  std::vector<std::thread> threadList;
+// Flush subnormal values to zero on the calling thread for the lifetime of the scope
+class FlushDenormals
+{
+public:
+  explicit FlushDenormals(bool enable) : saved(getDenormalMode()) { if ( enable ) setDenormalMode(DENORMAL_FLUSH); }
+  ~FlushDenormals() { restore(); }
+  void restore() { setDenormalMode(saved); }
+private:
+  unsigned saved;
+};
 
-  // Assign tasks to threads
-  for ( auto i : boost::irange(0,threadCount) )
-    threadList.emplace_back(lambda,startVals[i],endVals[i]);
+// Construct pool with (threadCount-1) persistent workers; the calling thread makes up the remainder
+GP::ThreadPool::ThreadPool(int threadCount, bool pin)
+{
+  if ( threadCount <= 0 )
+    threadCount = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
 
-  // Join threads
-  for ( auto & thread : threadList )
-    thread.join();
+  for ( auto i : boost::irange(0,threadCount-1) )
+    {
+      (void)i;
+      queues.emplace_back(new Queue);
+    }
+  for ( auto i : boost::irange(0,threadCount-1) )
+    workers.emplace_back(&ThreadPool::workerLoop, this, i);
 
-  
+  if ( pin )
+    pinThreads();
 }
 
-// Re-assemble pairwise distances into a dense matrix
-void GP::squareForm(Matrix & D, Matrix & Dv, int n, double diagVal)
+// Signal workers to exit and join them
+GP::ThreadPool::~ThreadPool()
 {
-  D.resize(n,n);
+  {
+    std::lock_guard<std::mutex> lock(sleepMutex);
+    stopping = true;
+  }
+  wake.notify_all();
+  for ( auto & worker : workers )
+    worker.join();
+}
 
-  // Get thread count
-  int threadCount = Eigen::nbThreads( );
-      
-  // Get problem dimension d per thread
-  auto d = static_cast<int>(n/threadCount);
+// Queue a task on the current worker's deque, or distribute round-robin from outside the pool
+void GP::ThreadPool::submit(Task task)
+{
+  // Run inline when there are no workers
+  if ( queues.empty() )
+    {
+      task();
+      return;
+    }
   
-  std::vector<int> startVals;
-  for ( auto i : boost::irange(0,threadCount) )
-    startVals.emplace_back(i*d);
-
-  std::vector<int> endVals;
-  for ( auto i : boost::irange(1,threadCount) )
-    endVals.emplace_back(i*d);
-  endVals.emplace_back(n-1);
-
-  // Define lambda function specifying each threads solver task
-  auto lambda = [&D,&Dv,n](int startInd, int endInd) {
-                  for ( auto i : boost::irange(startInd,endInd) )
+  int index = ( workerIndex >= 0 ) ? workerIndex : static_cast<int>(nextQueue++ % queues.size());
+  {
+    std::lock_guard<std::mutex> lock(queues[index]->mutex);
+    queues[index]->tasks.push_back(std::move(task));
+    queued++;
+  }
+
+  // Synchronize with workers that are about to sleep so the wake-up cannot be missed
+  { std::lock_guard<std::mutex> lock(sleepMutex); }
+  wake.notify_one();
+}
+
+// Pop from the back of the worker's own deque, otherwise steal from the front of another deque
+bool GP::ThreadPool::popTask(int index, Task & task)
+{
+  auto count = static_cast<int>(queues.size());
+  if ( index >= 0 )
+    {
+      std::lock_guard<std::mutex> lock(queues[index]->mutex);
+      if ( !queues[index]->tasks.empty() )
+        {
+          task = std::move(queues[index]->tasks.back());
+          queues[index]->tasks.pop_back();
+          queued--;
+          return true;
+        }
+    }
+  int offset = ( index >= 0 ) ? index + 1 : 0;
+  for ( auto k : boost::irange(0,count) )
+    {
+      int victim = (offset + k) % count;
+      if ( victim == index )
+        continue;
+      std::lock_guard<std::mutex> lock(queues[victim]->mutex);
+      if ( !queues[victim]->tasks.empty() )
+        {
+          task = std::move(queues[victim]->tasks.front());
+          queues[victim]->tasks.pop_front();
+          queued--;
+          return true;
+        }
+    }
+  return false;
+}
+
+// Execute one queued task on the calling thread
+bool GP::ThreadPool::runPending()
+{
+  Task task;
+  if ( !popTask(workerIndex, task) )
+    return false;
+  task();
+  return true;
+}
+
+// Worker loop: run local/stolen tasks and sleep when the pool is idle
+void GP::ThreadPool::workerLoop(int index)
+{
+  workerIndex = index;
+
+  // Workers provide task-level parallelism; keep Eigen/OpenMP kernels inside tasks single-threaded
+#ifdef _OPENMP
+  omp_set_num_threads(1);
+#endif
+  Task task;
+  while ( true )
+    {
+      if ( popTask(index, task) )
+        {
+          task();
+          task = nullptr;
+          continue;
+        }
+      std::unique_lock<std::mutex> lock(sleepMutex);
+      wake.wait(lock, [this] { return stopping || queued > 0; });
+      if ( stopping && queued == 0 )
+        return;
+    }
+}
+
+// Apply fn to chunks of [begin,end); idle threads claim the next chunk from a shared counter
+void GP::ThreadPool::parallelFor(int begin, int end, int chunk, LoopBody fn, int width)
+{
+  if ( end <= begin )
+    return;
+  chunk = std::max(1, chunk);
+  int chunkCount = (end - begin + chunk - 1) / chunk;
+  width = ( width <= 0 ) ? this->width() : std::min(width, size());
+  int helperCount = std::min(width, chunkCount) - 1;
+
+  // Run serially when a single chunk/thread is requested
+  if ( helperCount <= 0 )
+    {
+      fn(begin, end);
+      return;
+    }
+
+  std::atomic<int> nextChunk{0};
+  std::atomic<int> activeHelpers{helperCount};
+  unsigned denormalMode = getDenormalMode();
+  std::exception_ptr error = nullptr;
+  std::mutex errorMutex;
+
+  // Nested loops started inside chunks inherit the caller's width
+  // [ Eigen kernels inside chunks run single-threaded on the calling thread as well as on the workers ]
+  auto body = [&]() {
+                int savedWidth = loopWidth;
+                loopWidth = width;
+                unsigned savedMode = getDenormalMode();
+                setDenormalMode(denormalMode);
+#ifdef _OPENMP
+                int savedBlas = omp_get_max_threads();
+                omp_set_num_threads(1);
+#endif
+                try
+                  {
+                    for ( int c = nextChunk++; c < chunkCount; c = nextChunk++ )
+                      fn(begin + c*chunk, std::min(end, begin + (c+1)*chunk));
+                  }
+                catch (...)
+                  {
+                    std::lock_guard<std::mutex> lock(errorMutex);
+                    if ( !error )
+                      error = std::current_exception();
+                    nextChunk = chunkCount;
+                  }
+#ifdef _OPENMP
+                omp_set_num_threads(savedBlas);
+#endif
+                setDenormalMode(savedMode);
+                loopWidth = savedWidth;
+              };
+
+  for ( auto i : boost::irange(0,helperCount) )
+    {
+      (void)i;
+      submit([&body,&activeHelpers]() { body(); activeHelpers--; });
+    }
+
+  // The calling thread works on chunks too, then helps with queued tasks until all helpers have finished
+  body();
+  while ( activeHelpers > 0 )
+    {
+      if ( !runPending() )
+        std::this_thread::yield();
+    }
+
+  if ( error )
+    std::rethrow_exception(error);
+}
+
+// Get the default loop width for the calling thread
+int GP::ThreadPool::width() const
+{
+  return ( loopWidth > 0 ) ? std::min(loopWidth, size()) : size();
+}
+
+// Pin worker i to the (i+1)-th core of the process affinity mask so that the calling thread keeps the first one
+//   [ returns false, leaving the remaining workers unpinned, when the mask cannot be read or a core is refused ]
+bool GP::ThreadPool::pinThreads()
+{
+#ifdef __linux__
+  cpu_set_t allowed;
+  CPU_ZERO(&allowed);
+  if ( sched_getaffinity(0, sizeof(cpu_set_t), &allowed) != 0 )
+    return false;
+  std::vector<int> cores;
+  for ( auto c : boost::irange(0,CPU_SETSIZE) )
+    if ( CPU_ISSET(c, &allowed) )
+      cores.push_back(c);
+  if ( cores.empty() )
+    return false;
+  for ( auto i : boost::irange(0,static_cast<int>(workers.size())) )
+    {
+      cpu_set_t cpuset;
+      CPU_ZERO(&cpuset);
+      CPU_SET(cores[(i+1) % cores.size()], &cpuset);
+      if ( pthread_setaffinity_np(workers[i].native_handle(), sizeof(cpu_set_t), &cpuset) != 0 )
+        return false;
+    }
+  return true;
+#else
+  return false;
+#endif
+}
+
+// Retrieve the library-owned thread pool [ constructed on first use ]
+GP::ThreadPool & GP::threadPool()
+{
+  static ThreadPool pool;
+  return pool;
+}
+
+
+//
+//   [ Thread Budget ]
+//
+
+// Number of models currently inside a ThreadScope [ used to divide the default budget ]
+static std::atomic<int> activeModels{0};
+
+// Count usable cores: OMP_NUM_THREADS if set, otherwise the process affinity mask
+int GP::availableCores()
+{
+  if ( const char * env = std::getenv("OMP_NUM_THREADS") )
+    {
+      int count = std::atoi(env);
+      if ( count > 0 )
+        return count;
+    }
+#ifdef __linux__
+  cpu_set_t cpuset;
+  if ( sched_getaffinity(0, sizeof(cpu_set_t), &cpuset) == 0 )
+    return std::max(1, CPU_COUNT(&cpuset));
+#endif
+  return std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+}
+
+// Get the physical memory of the host
+double GP::physicalMemory()
+{
+#ifdef __linux__
+  long pages = sysconf(_SC_PHYS_PAGES);
+  long pageSize = sysconf(_SC_PAGE_SIZE);
+  if ( ( pages > 0 ) && ( pageSize > 0 ) )
+    return static_cast<double>(pages) * static_cast<double>(pageSize);
+#endif
+  return 0.0;
+}
+
+// Fill automatic entries: the measured core count is split evenly between models running concurrently
+GP::ThreadConfig GP::ThreadScope::resolve(const ThreadConfig & config)
+{
+  static const int cores = availableCores();
+  ThreadConfig resolved = config;
+  if ( resolved.totalThreads <= 0 )
+    resolved.totalThreads = std::max(1, cores / std::max(1, activeModels.load()));
+  if ( resolved.blasThreads <= 0 )
+    resolved.blasThreads = resolved.totalThreads;
+  if ( resolved.taskThreads <= 0 )
+    resolved.taskThreads = resolved.totalThreads;
+  resolved.blasThreads = std::min(resolved.blasThreads, resolved.totalThreads);
+  resolved.taskThreads = std::min(resolved.taskThreads, resolved.totalThreads);
+  return resolved;
+}
+
+// Register the model as active and apply its budget to Eigen/OpenMP and to thread pool loops on this thread
+GP::ThreadScope::ThreadScope(const ThreadConfig & config)
+{
+  activeModels++;
+  ThreadConfig resolved = resolve(config);
+
+  previousWidth = loopWidth;
+  loopWidth = resolved.taskThreads;
+
+  // [ omp_set_num_threads only affects the calling thread, so concurrent models do not interfere ]
+#ifdef _OPENMP
+  previousBlas = omp_get_max_threads();
+  omp_set_num_threads(resolved.blasThreads);
+#else
+  previousBlas = 1;
+#endif
+
+  // [ OpenBLAS keeps a single process-wide thread count, so the most recently started model sets it ]
+#if defined(GP_USE_LAPACKE) && defined(OPENBLAS_VERSION)
+  openblas_set_num_threads(resolved.blasThreads);
+#endif
+
+  if ( resolved.pinThreads )
+    {
+      static std::once_flag pinned;
+      std::call_once(pinned, [] { threadPool().pinThreads(); });
+    }
+}
+
+// Restore the previous budget of the calling thread
+GP::ThreadScope::~ThreadScope()
+{
+  loopWidth = previousWidth;
+#ifdef _OPENMP
+  omp_set_num_threads(previousBlas);
+#endif
+#if defined(GP_USE_LAPACKE) && defined(OPENBLAS_VERSION)
+  openblas_set_num_threads(previousBlas);
+#endif
+  activeModels--;
+}
+
+
+// Add task to the graph
+int GP::TaskGraph::addTask(const Args & args, int priority)
+{
+  nodes.emplace_back();
+  nodes.back().args = args;
+  nodes.back().priority = priority;
+  return static_cast<int>(nodes.size()) - 1;
+}
+
+// Record dependency edge  prerequisite -> task
+void GP::TaskGraph::addDependency(int task, int prerequisite)
+{
+  nodes[prerequisite].successors.push_back(task);
+  nodes[task].dependencies += 1;
+}
+
+// Run the graph on at most 'width' threads: each thread repeatedly takes the highest priority ready task
+// [ Eigen kernels inside tasks run single-threaded, as in parallelFor.  Helpers leave the graph when no task is ready, and
+//   completing tasks submit new helpers for the successors they release, so that pool workers are not held by serial
+//   stretches of the graph (e.g. the POTRF panel chain); the calling thread runs other queued pool tasks while it waits ]
+void GP::TaskGraph::run(LoopBody fn, ThreadPool & pool)
+{
+  auto count = static_cast<int>(nodes.size());
+  if ( count == 0 )
+    return;
+
+  // Ready tasks ordered by priority, then by insertion order  [ both buffers keep their capacity between runs ]
+  remaining.resize(count);
+  ready.clear();
+  ready.reserve(count);
+  std::mutex readyMutex;
+  for ( auto i : boost::irange(0,count) )
+    {
+      remaining[i] = nodes[i].dependencies;
+      if ( remaining[i] == 0 )
+        ready.emplace_back(nodes[i].priority, -i);
+    }
+  std::make_heap(ready.begin(), ready.end());
+
+  int width = std::min(pool.width(), count);
+  int unfinished = count;
+  int helpers = 0;                       // Submitted helpers which have not left the graph  [ guarded by readyMutex ]
+  std::atomic<bool> failed{false};
+  std::exception_ptr error = nullptr;
+  std::mutex errorMutex;
+  unsigned denormalMode = getDenormalMode();
+
+  // Submit helpers for the ready tasks beyond the one taken by the calling thread  [ called with readyMutex held;
+  //   returns the number of helpers to submit once it is released ]
+  auto recruit = [&]() {
+                   int extra = std::max(0, std::min(static_cast<int>(ready.size()) - 1, width - 1 - helpers));
+                   helpers += extra;
+                   return extra;
+                 };
+  std::function<void()> helper;
+  auto submitHelpers = [&](int extra) {
+                         for ( auto k : boost::irange(0,extra) )
+                           {
+                             (void)k;
+                             pool.submit(helper);
+                           }
+                       };
+
+  // Execute ready tasks until none is left  [ helpers leave when no task is ready; the calling thread stays until the
+  //   graph has completed and all helpers have left ]
+  auto body = [&](bool caller) {
+                int savedWidth = loopWidth;
+                loopWidth = width;
+                unsigned savedMode = getDenormalMode();
+                setDenormalMode(denormalMode);
+#ifdef _OPENMP
+                int savedBlas = omp_get_max_threads();
+                omp_set_num_threads(1);
+#endif
+                while ( true )
+                  {
+                    int i = -1;
+                    bool done = false;
                     {
-                      for ( auto j : boost::irange(i+1, n) )
-                       D(i,j) = D(j,i) = Dv(static_cast<int>(i*n-(i*(i+1))/2+j-i-1), 0);
+                      std::lock_guard<std::mutex> lock(readyMutex);
+                      if ( !ready.empty() )
+                        {
+                          std::pop_heap(ready.begin(), ready.end());
+                          i = -ready.back().second;
+                          ready.pop_back();
+                        }
+                      else if ( !caller )
+                        {
+                          helpers -= 1;
+                          done = true;
+                        }
+                      else
+                        done = ( unfinished == 0 ) && ( helpers == 0 );
                     }
-                };
+                    if ( done )
+                      break;
+                    if ( i < 0 )
+                      {
+                        if ( !pool.runPending() )
+                          std::this_thread::yield();
+                        continue;
+                      }
+
+                    // Remaining tasks are skipped (but still released) once a task has thrown
+                    try
+                      {
+                        if ( !failed )
+                          fn(i, i+1);
+                      }
+                    catch (...)
+                      {
+                        std::lock_guard<std::mutex> lock(errorMutex);
+                        if ( !error )
+                          error = std::current_exception();
+                        failed = true;
+                      }
+
+                    int extra;
+                    {
+                      std::lock_guard<std::mutex> lock(readyMutex);
+                      for ( auto j : nodes[i].successors )
+                        {
+                          if ( --remaining[j] == 0 )
+                            {
+                              ready.emplace_back(nodes[j].priority, -j);
+                              std::push_heap(ready.begin(), ready.end());
+                            }
+                        }
+                      unfinished -= 1;
+                      extra = recruit();
+                    }
+                    submitHelpers(extra);
+                  }
+#ifdef _OPENMP
+                omp_set_num_threads(savedBlas);
+#endif
+                setDenormalMode(savedMode);
+                loopWidth = savedWidth;
+              };
+
+  // [ A helper leaves the graph under readyMutex, after which it only restores its own thread state ]
+  helper = [&body]() { body(false); };
+
+  int extra;
+  {
+    std::lock_guard<std::mutex> lock(readyMutex);
+    extra = recruit();
+  }
+  submitHelpers(extra);
+  body(true);
+
+  if ( error )
+    std::rethrow_exception(error);
+}
+
 
-  // Initialize thread list
-  std::vector<std::thread> threadList;
+//
+//   [ Distance Utilities ]
+//
+
+// Compute pairwise distance between lists of points
+void GP::pdist(Matrix & Dv, Matrix & X1, Matrix & X2)
+{
+  auto n = static_cast<int>(X1.rows());
+  auto entryCount = static_cast<int>( (n*(n-1))/2);
+  Dv.resize(entryCount, 1);
 
-  // Assign tasks to threads
-  for ( auto i : boost::irange(0,threadCount) )
-    threadList.emplace_back(lambda,startVals[i],endVals[i]);
+  // Rows are claimed in small chunks so that the triangular workload stays balanced
+  threadPool().parallelFor(0, n-1, 8, [&Dv,&X1,&X2,n](int startInd, int endInd) {
+                                        for ( auto i : boost::irange(startInd, endInd) )
+                                          {      
+                                            for ( auto j : boost::irange(i+1,n) )
+                                              Dv(static_cast<int>(i*n-(i*(i+1))/2+j-i-1), 0) = (X1.row(i)-X2.row(j)).squaredNorm();
+                                          }
+                                      });
+}
 
-  // Join threads
-  for ( auto & thread : threadList )
-    thread.join();
+// Re-assemble pairwise distances into a dense matrix
+void GP::squareForm(Matrix & D, Matrix & Dv, int n, double diagVal)
+{
+  D.resize(n,n);
 
+  // Rows are claimed in small chunks so that the triangular workload stays balanced
+  threadPool().parallelFor(0, n-1, 8, [&D,&Dv,n](int startInd, int endInd) {
+                                        for ( auto i : boost::irange(startInd,endInd) )
+                                          {
+                                            for ( auto j : boost::irange(i+1, n) )
+                                              D(i,j) = D(j,i) = Dv(static_cast<int>(i*n-(i*(i+1))/2+j-i-1), 0);
+                                          }
+                                      });
   
   // Add diagonal values to distance matrix
   D.diagonal() = diagVal * Eigen::MatrixXd::Ones(n,1);
 }
 
 
-// Parse kernel parameter vector, separating noise from the kernel hyperparameters
-void GP::Kernel::parseParams(const Vector & params, Vector & kernelParams, std::vector<double> & nonKernelParams)
+// Compute dense matrix of squared distances  D(i,j) = ||x1_i||^2 + ||x2_j||^2 - 2 x1_i.x2_j
+// [ Note: the cross terms are formed with a single GEMM instead of pairwise differences ]
+void GP::sqDist(Matrix & D, const Matrix & X1, const Matrix & X2)
 {
-  if ( !fixedNoise )
+  auto m = static_cast<int>(X1.rows());
+  auto n = static_cast<int>(X2.rows());
+  bool symmetric = ( &X1 == &X2 );
+
+  // Center inputs to limit cancellation error in the norm expansion (distances are shift invariant)
+  Eigen::RowVectorXd center = X1.colwise().mean();
+  Matrix X1c = X1.rowwise() - center;
+  Matrix X2c = X2.rowwise() - center;
+  Vector n1 = X1c.rowwise().squaredNorm();
+  Vector n2 = X2c.rowwise().squaredNorm();
+
+  // Form cross terms  -2 * X1 * X2^T
+  D.resize(m,n);
+  D.noalias() = -2.0 * X1c * X2c.transpose();
+
+  // Add norms in a single sweep, clamping round-off below zero
+  threadPool().parallelFor(0, n, 64, [&D,&n1,&n2](int startCol, int endCol) {
+                                       for ( auto j : boost::irange(startCol,endCol) )
+                                         D.col(j) = ( D.col(j).array() + n1.array() + n2(j) ).max(0.0).matrix();
+                                     });
+
+  // Distances from points to themselves are exactly zero
+  if ( symmetric )
+    D.diagonal().setZero();
+}
+
+
+// Get squared distances from observation j to a contiguous range of observations
+const double * GP::DistanceView::segment(int j, int r0, int len, double * buffer) const
+{
+  if ( dense )
+    return dense->data() + static_cast<std::size_t>(j)*dense->rows() + r0;
+
+  // Accumulate one input dimension at a time so that the inner loop runs over contiguous memory
+  const Matrix & X = *inputs;
+  auto n = static_cast<std::size_t>(X.rows());
+  std::fill(buffer, buffer+len, 0.0);
+  for ( auto k : boost::irange(0,static_cast<int>(X.cols())) )
     {
-      // Noise = params(0)
-      nonKernelParams.emplace_back(params(0));
-      if ( !fixedScaling )
-        nonKernelParams.emplace_back(params(1));
-      else
-        nonKernelParams.emplace_back(scalingLevel);
+      const double * x = X.data() + k*n + r0;
+      double xj = X(j,k);
+      for ( auto r : boost::irange(0,len) )
+        {
+          double diff = x[r] - xj;
+          buffer[r] += diff*diff;
+        }
     }
-  else
+  return buffer;
+}
+
+
+// Define limits of the exponential argument [ exp(x) underflows to zero below EXP_LO ]
+static const double EXP_LO = -708.3964185322641;
+static const double EXP_HI = 709.782712893384;
+
+// Scalar exponential kernel  y = b * exp(a*x)
+static void vexpScalar(const double * x, double * y, std::size_t count, double a, double b)
+{
+  for ( std::size_t i = 0; i < count; i++ )
+    y[i] = b * std::exp(a*x[i]);
+}
+
+#ifdef GP_X86_DISPATCH
+
+//
+//  Vectorized exponential using Cody-Waite range reduction and the Cephes Pade approximant:
+//
+//    exp(x) = 2^n * exp(r),   r = x - n*ln(2),   exp(r) = 1 + 2*r*P(r^2) / ( Q(r^2) - r*P(r^2) )
+//
+static const double EXP_LOG2E = 1.4426950408889634073599;
+static const double EXP_C1 = 6.93145751953125e-1;
+static const double EXP_C2 = 1.42860682030941723212e-6;
+static const double EXP_P0 = 1.26177193074810590878e-4;
+static const double EXP_P1 = 3.02994407707441961300e-2;
+static const double EXP_P2 = 9.99999999999999999910e-1;
+static const double EXP_Q0 = 3.00198505138664455042e-6;
+static const double EXP_Q1 = 2.52448340349684104192e-3;
+static const double EXP_Q2 = 2.27265548208155028766e-1;
+static const double EXP_Q3 = 2.00000000000000000009e0;
+
+__attribute__((target("avx2,fma")))
+static void vexpAVX2(const double * x, double * y, std::size_t count, double a, double b)
+{
+  const __m256d va = _mm256_set1_pd(a);
+  const __m256d vb = _mm256_set1_pd(b);
+  const __m256d lo = _mm256_set1_pd(EXP_LO);
+  const __m256d hi = _mm256_set1_pd(EXP_HI);
+  const __m256d zero = _mm256_setzero_pd();
+
+  std::size_t i = 0;
+  for ( ; i + 4 <= count; i += 4 )
     {
-      // Scaling = params(0)
-      nonKernelParams.emplace_back(noiseLevel);
-      if ( !fixedScaling )
-        nonKernelParams.emplace_back(params(0));
-      else
-        nonKernelParams.emplace_back(scalingLevel);
+      __m256d v = _mm256_mul_pd(va, _mm256_loadu_pd(x+i));
+      __m256d under = _mm256_cmp_pd(v, lo, _CMP_LT_OQ);
+      v = _mm256_min_pd(_mm256_max_pd(v, lo), hi);
+
+      // Range reduction
+      __m256d n = _mm256_round_pd(_mm256_mul_pd(v, _mm256_set1_pd(EXP_LOG2E)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+      __m256d r = _mm256_fnmadd_pd(n, _mm256_set1_pd(EXP_C1), v);
+      r = _mm256_fnmadd_pd(n, _mm256_set1_pd(EXP_C2), r);
+
+      // Pade approximant on the reduced argument
+      __m256d r2 = _mm256_mul_pd(r, r);
+      __m256d p = _mm256_fmadd_pd(_mm256_fmadd_pd(_mm256_set1_pd(EXP_P0), r2, _mm256_set1_pd(EXP_P1)), r2, _mm256_set1_pd(EXP_P2));
+      p = _mm256_mul_pd(p, r);
+      __m256d q = _mm256_fmadd_pd(_mm256_fmadd_pd(_mm256_fmadd_pd(_mm256_set1_pd(EXP_Q0), r2, _mm256_set1_pd(EXP_Q1)), r2, _mm256_set1_pd(EXP_Q2)), r2, _mm256_set1_pd(EXP_Q3));
+      __m256d e = _mm256_div_pd(p, _mm256_sub_pd(q, p));
+      e = _mm256_fmadd_pd(_mm256_set1_pd(2.0), e, _mm256_set1_pd(1.0));
+
+      // Scale by 2^n via the exponent bits [ split as 2^(n/2) * 2^(n-n/2) to stay in range at both ends ]
+      __m128i n32 = _mm256_cvtpd_epi32(n);
+      __m128i n1 = _mm_srai_epi32(n32, 1);
+      __m128i n2 = _mm_sub_epi32(n32, n1);
+      const __m256i bias = _mm256_set1_epi64x(1023);
+      __m256i bits1 = _mm256_slli_epi64(_mm256_add_epi64(_mm256_cvtepi32_epi64(n1), bias), 52);
+      __m256i bits2 = _mm256_slli_epi64(_mm256_add_epi64(_mm256_cvtepi32_epi64(n2), bias), 52);
+      e = _mm256_mul_pd(_mm256_mul_pd(e, _mm256_castsi256_pd(bits1)), _mm256_castsi256_pd(bits2));
+
+      e = _mm256_blendv_pd(e, zero, under);
+      _mm256_storeu_pd(y+i, _mm256_mul_pd(vb, e));
     }
 
-  // Trim kernel parameter vector
-  kernelParams = params.tail(paramCount);
+  vexpScalar(x+i, y+i, count-i, a, b);
+}
+
+// [ GCC reports a spurious -Wmaybe-uninitialized from the AVX-512 min/max intrinsic headers ]
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+__attribute__((target("avx512f")))
+static void vexpAVX512(const double * x, double * y, std::size_t count, double a, double b)
+{
+  const __m512d va = _mm512_set1_pd(a);
+  const __m512d vb = _mm512_set1_pd(b);
+  const __m512d lo = _mm512_set1_pd(EXP_LO);
+  const __m512d hi = _mm512_set1_pd(EXP_HI);
+
+  std::size_t i = 0;
+  for ( ; i + 8 <= count; i += 8 )
+    {
+      __m512d v = _mm512_mul_pd(va, _mm512_loadu_pd(x+i));
+      __mmask8 keep = _mm512_cmp_pd_mask(v, lo, _CMP_GE_OQ);
+      v = _mm512_min_pd(_mm512_max_pd(v, lo), hi);
+
+      // Range reduction
+      __m512d n = _mm512_roundscale_pd(_mm512_mul_pd(v, _mm512_set1_pd(EXP_LOG2E)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+      __m512d r = _mm512_fnmadd_pd(n, _mm512_set1_pd(EXP_C1), v);
+      r = _mm512_fnmadd_pd(n, _mm512_set1_pd(EXP_C2), r);
+
+      // Pade approximant on the reduced argument
+      __m512d r2 = _mm512_mul_pd(r, r);
+      __m512d p = _mm512_fmadd_pd(_mm512_fmadd_pd(_mm512_set1_pd(EXP_P0), r2, _mm512_set1_pd(EXP_P1)), r2, _mm512_set1_pd(EXP_P2));
+      p = _mm512_mul_pd(p, r);
+      __m512d q = _mm512_fmadd_pd(_mm512_fmadd_pd(_mm512_fmadd_pd(_mm512_set1_pd(EXP_Q0), r2, _mm512_set1_pd(EXP_Q1)), r2, _mm512_set1_pd(EXP_Q2)), r2, _mm512_set1_pd(EXP_Q3));
+      __m512d e = _mm512_div_pd(p, _mm512_sub_pd(q, p));
+      e = _mm512_fmadd_pd(_mm512_set1_pd(2.0), e, _mm512_set1_pd(1.0));
+
+      // Scale by 2^n
+      e = _mm512_scalef_pd(e, n);
+
+      _mm512_storeu_pd(y+i, _mm512_maskz_mul_pd(keep, vb, e));
+    }
 
+  vexpScalar(x+i, y+i, count-i, a, b);
 }
+#pragma GCC diagnostic pop
 
-// Compute covariance matrix (and gradients) from a vector of squared pairwise distances Dv
-void GP::RBF::computeCov(Matrix & K, Matrix & obsX, Vector & params, std::vector<Matrix> & gradList, double jitter, bool evalGrad)
+#endif
+
+// Select the widest exponential kernel supported by the host CPU
+using VexpKernel = void (*)(const double *, double *, std::size_t, double, double);
+static VexpKernel selectVexp(const char ** name)
 {
-  auto n = static_cast<int>(K.rows());
+#ifdef GP_X86_DISPATCH
+  __builtin_cpu_init();
+  if ( __builtin_cpu_supports("avx512f") )
+    { *name = "AVX-512"; return vexpAVX512; }
+  if ( __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") )
+    { *name = "AVX2"; return vexpAVX2; }
+#endif
+  *name = "scalar";
+  return vexpScalar;
+}
 
-  // Separate noise and scaling parameters from kernel hyperparameters
-  Vector kernelParams;
-  std::vector<double> noiseAndScaling;
-  parseParams(params, kernelParams, noiseAndScaling);
-  double noise = noiseAndScaling[0];
-  double scaling = noiseAndScaling[1];
-  
-  // Compute distance matrix for each call
-  Matrix Dv;
-  pdist(Dv, obsX, obsX);
+// Resolve the kernel on first use [ safe to call from static initializers in other translation units ]
+static VexpKernel getVexp(const char ** name=nullptr)
+{
+  static const char * selectedName = "scalar";
+  static const VexpKernel selected = selectVexp(&selectedName);
+  if ( name )
+    *name = selectedName;
+  return selected;
+}
+
+// Compute  y = b * exp(a*x)  elementwise [ x and y may alias ]
+void GP::vexp(const double * x, double * y, std::size_t count, double a, double b)
+{
+  static const VexpKernel kernel = getVexp();
+  kernel(x, y, count, a, b);
+}
+
+// Retrieve the name of the instruction set used by GP::vexp
+const char * GP::vexpISA()
+{
+  const char * name;
+  getVexp(&name);
+  return name;
+}
+
+
+//
+//   [ Dense Linear Algebra ]
+//
+
+// Maximum block size for spdInverse [ product blocks are held on the stack ]
+static const int SPD_MAX_BLOCK = 64;
+template <typename Scalar>
+using BlockBuffer = Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic, Eigen::ColMajor, SPD_MAX_BLOCK, SPD_MAX_BLOCK>;
+
+#ifdef GP_USE_LAPACKE
+// Select single/double precision LAPACKE routines by overload
+static lapack_int lapackPotrf(lapack_int n, double * a, lapack_int lda) { return LAPACKE_dpotrf(LAPACK_COL_MAJOR, 'L', n, a, lda); }
+static lapack_int lapackPotrf(lapack_int n, float * a, lapack_int lda) { return LAPACKE_spotrf(LAPACK_COL_MAJOR, 'L', n, a, lda); }
+static lapack_int lapackPotri(lapack_int n, double * a, lapack_int lda) { return LAPACKE_dpotri(LAPACK_COL_MAJOR, 'L', n, a, lda); }
+static lapack_int lapackPotri(lapack_int n, float * a, lapack_int lda) { return LAPACKE_spotri(LAPACK_COL_MAJOR, 'L', n, a, lda); }
+#endif
+
+// Retrieve the name of a linear algebra backend
+const char * GP::backendName(Backend backend)
+{
+  return ( backendAvailable(backend) && backend == Backend::Lapacke ) ? "LAPACKE" : "Eigen";
+}
+
+// Check whether a backend was compiled in [ unavailable backends fall back to Eigen ]
+bool GP::backendAvailable(Backend backend)
+{
+#ifdef GP_USE_LAPACKE
+  return true;
+#else
+  return ( backend == Backend::Eigen );
+#endif
+}
+
+// Choose a tile size giving at least ~8 tile tasks per thread in the trailing updates  [ returns n when tiling does not pay off ]
+int GP::defaultTileSize(int n, int threadCount)
+{
+  if ( threadCount <= 1 )
+    return n;
+  int size = static_cast<int>( n / std::sqrt(16.0*threadCount) );
+  size = std::max(128, std::min(512, (size/32)*32));
+  return ( 2*size <= n ) ? size : n;
+}
+
+// Build the task graph of a tiled Cholesky factorization with nt x nt tiles:
+//
+//   for k:  POTRF A(k,k);  TRSM A(i,k) for i > k;  SYRK A(i,i) and GEMM A(i,j) for k < j < i
+//
+// [ Each task depends on the last task which wrote any tile it reads or writes; the current panel is prioritized.
+//   Task arguments are {kind, i, j, k}, with kinds 0-3 in the order above ]
+static void buildTiledCholeskyGraph(GP::TaskGraph & graph, int nt)
+{
+  graph.clear();
+  std::vector<int> lastWriter(static_cast<std::size_t>(nt)*nt, -1);
+  auto addTileTask = [&](const GP::TaskGraph::Args & args, int priority, int wi, int wj, int ri1, int rj1, int ri2, int rj2) {
+                       int task = graph.addTask(args, priority);
+                       for ( auto index : { wi + wj*nt, ri1 + rj1*nt, ri2 + rj2*nt } )
+                         {
+                           if ( index >= 0 && lastWriter[index] >= 0 )
+                             graph.addDependency(task, lastWriter[index]);
+                         }
+                       lastWriter[wi + wj*nt] = task;
+                     };
+
+  for ( auto k : boost::irange(0,nt) )
+    {
+      int priority = 2*(nt - k);
+      addTileTask({0, k, k, k}, priority+1, k, k, -1, 0, -1, 0);
+
+      for ( auto i : boost::irange(k+1,nt) )
+        addTileTask({1, i, k, k}, priority+1, i, k, k, k, -1, 0);
+
+      for ( auto i : boost::irange(k+1,nt) )
+        {
+          // Updates feeding the next panel lie on the critical path
+          addTileTask({2, i, i, k}, ( i == k+1 ) ? priority : priority-1, i, i, i, k, -1, 0);
+
+          for ( auto j : boost::irange(k+1,i) )
+            addTileTask({3, i, j, k}, ( j == k+1 ) ? priority : priority-1, i, j, i, k, j, k);
+        }
+    }
+}
+
+// Count the tasks of a tiled Cholesky graph with nt x nt tiles  [ identifies a graph built for the same tile count ]
+static int tiledCholeskyTaskCount(int nt)
+{
+  int count = 0;
+  for ( auto k : boost::irange(0,nt) )
+    {
+      int m = nt - k - 1;
+      count += 1 + 2*m + (m*(m-1))/2;
+    }
+  return count;
+}
+
+// Factor A = L*L^T in place as a task graph over lower triangular tiles  [ see buildTiledCholeskyGraph ]
+template <typename MatrixType>
+static bool tiledCholeskyImpl(MatrixType & A, int tileSize, GP::TaskGraph * graph)
+{
+  using Scalar = typename MatrixType::Scalar;
+  auto n = static_cast<int>(A.rows());
+  int ts = std::max(1, tileSize);
+  int nt = (n + ts - 1)/ts;
+  auto tile = [&A,ts,n](int i, int j) { return A.block(i*ts, j*ts, std::min(ts, n-i*ts), std::min(ts, n-j*ts)); };
+
+  GP::TaskGraph local;
+  GP::TaskGraph & tasks = graph ? *graph : local;
+  if ( tasks.size() != tiledCholeskyTaskCount(nt) )
+    buildTiledCholeskyGraph(tasks, nt);
+
+  std::atomic<bool> failed{false};
+  auto body = [&](int task, int) {
+                if ( failed )
+                  return;
+                const auto & args = tasks.args(task);
+                int i = args[1], j = args[2], k = args[3];
+                switch ( args[0] )
+                  {
+                  case 0:
+                    {
+                      auto Akk = tile(k,k);
+                      Eigen::LLT<Eigen::Ref<MatrixType>> llt(Akk);
+                      if ( llt.info() != Eigen::Success )
+                        failed = true;
+                      break;
+                    }
+                  case 1:
+                    {
+                      auto Aik = tile(i,k);
+                      tile(k,k).template triangularView<Eigen::Lower>().transpose().template solveInPlace<Eigen::OnTheRight>(Aik);
+                      break;
+                    }
+                  case 2:
+                    tile(i,i).template selfadjointView<Eigen::Lower>().rankUpdate(tile(i,k), Scalar(-1));
+                    break;
+                  default:
+                    tile(i,j).noalias() -= tile(i,k) * tile(j,k).transpose();
+                  }
+              };
+  tasks.run(body);
+  return !failed;
+}
+
+// Factor A = L*L^T in place [ the strict upper triangle of A is left untouched ]
+template <typename MatrixType>
+static bool choleskyFactorImpl(MatrixType & A, GP::Backend backend, int tileSize, GP::TaskGraph * graph)
+{
+  auto n = static_cast<int>(A.rows());
+#ifdef GP_USE_LAPACKE
+  if ( backend == GP::Backend::Lapacke )
+    return ( lapackPotrf(n, A.data(), static_cast<lapack_int>(A.outerStride())) == 0 );
+#endif
+  if ( tileSize <= 0 )
+    tileSize = GP::defaultTileSize(n, GP::threadPool().width());
+  if ( tileSize < n )
+    return tiledCholeskyImpl(A, tileSize, graph);
+
+  Eigen::LLT<Eigen::Ref<MatrixType>> llt(A);
+  return ( llt.info() == Eigen::Success );
+}
+
+bool GP::choleskyFactor(Matrix & A, Backend backend, int tileSize, TaskGraph * graph) { return choleskyFactorImpl(A, backend, tileSize, graph); }
+bool GP::choleskyFactor(MatrixF & A, Backend backend, int tileSize, TaskGraph * graph) { return choleskyFactorImpl(A, backend, tileSize, graph); }
+bool GP::tiledCholesky(Matrix & A, int tileSize, TaskGraph * graph) { return tiledCholeskyImpl(A, tileSize, graph); }
+bool GP::tiledCholesky(MatrixF & A, int tileSize, TaskGraph * graph) { return tiledCholeskyImpl(A, tileSize, graph); }
+
+// Copy the strict upper triangle of A into its strict lower triangle (reverse=false), or vice versa (reverse=true)
+// [ Each task writes only its own columns of the destination triangle ]
+static void mirrorTriangle(Matrix & A, bool reverse)
+{
+  auto n = static_cast<int>(A.rows());
+  GP::threadPool().parallelFor(0, n, 64, [&A,n,reverse](int startCol, int endCol) {
+                                           for ( auto j : boost::irange(startCol,endCol) )
+                                             {
+                                               if ( reverse )
+                                                 A.col(j).head(j) = A.row(j).head(j).transpose();
+                                               else
+                                                 A.col(j).tail(n-j-1) = A.row(j).tail(n-j-1).transpose();
+                                             }
+                                         });
+}
+
+// Factor A in place with escalating diagonal jitter [ the diagonal is saved so that A never needs to be reassembled ]
+GP::CholeskyInfo GP::robustCholesky(Matrix & A, double jitter, int maxAttempts, bool mirror, Backend backend, int tileSize, TaskGraph * graph,
+                                    Vector * saved)
+{
+  CholeskyInfo info;
+  auto n = static_cast<int>(A.rows());
+  if ( n == 0 )
+    {
+      info.success = true;
+      info.rcond = 1.0;
+      return info;
+    }
+  if ( mirror )
+    mirrorTriangle(A, true);
+
+  // The saved diagonal is reused between calls on the same model
+  Vector local;
+  Vector & diagonal = saved ? *saved : local;
+  diagonal = A.diagonal();
+  double scale = std::max(diagonal.mean(), std::numeric_limits<double>::min());
+  info.scale = scale;
+  double minRcond = n * std::numeric_limits<double>::epsilon();
+  for ( auto k : boost::irange(0,std::max(1,maxAttempts)) )
+    {
+      if ( k > 0 )
+        {
+          // Restore the lower triangle from the untouched upper triangle and add jitter to the diagonal
+          info.jitter = ( k == 1 ) ? std::max(jitter, std::numeric_limits<double>::epsilon())*scale : 10.0*info.jitter;
+          mirrorTriangle(A, false);
+          A.diagonal() = diagonal.array() + info.jitter;
+        }
+      info.attempts = k + 1;
+
+      if ( !choleskyFactor(A, backend, tileSize, graph) )
+        continue;
+      auto pivots = A.diagonal().array();
+      info.rcond = std::pow(pivots.minCoeff() / pivots.maxCoeff(), 2);
+      if ( std::isfinite(info.rcond) && info.rcond >= minRcond )
+        {
+          info.success = true;
+          return info;
+        }
+    }
+  return info;
+}
+
+// Solve (L L^T) X = B in place
+void GP::choleskySolve(const Matrix & L, Matrix & B, Backend backend)
+{
+#ifdef GP_USE_LAPACKE
+  if ( backend == Backend::Lapacke )
+    {
+      LAPACKE_dpotrs(LAPACK_COL_MAJOR, 'L', static_cast<lapack_int>(L.rows()), static_cast<lapack_int>(B.cols()),
+                     L.data(), static_cast<lapack_int>(L.outerStride()), B.data(), static_cast<lapack_int>(B.outerStride()));
+      return;
+    }
+#endif
+  L.triangularView<Eigen::Lower>().solveInPlace(B);
+  L.triangularView<Eigen::Lower>().transpose().solveInPlace(B);
+}
+
+// Solve L X = B in place
+void GP::triangularSolve(const Matrix & L, Matrix & B, Backend backend)
+{
+#ifdef GP_USE_LAPACKE
+  if ( backend == Backend::Lapacke )
+    {
+      cblas_dtrsm(CblasColMajor, CblasLeft, CblasLower, CblasNoTrans, CblasNonUnit,
+                  static_cast<int>(B.rows()), static_cast<int>(B.cols()), 1.0,
+                  L.data(), static_cast<int>(L.outerStride()), B.data(), static_cast<int>(B.outerStride()));
+      return;
+    }
+#endif
+  L.triangularView<Eigen::Lower>().solveInPlace(B);
+}
+
+// Compute the eigendecomposition A = Q diag(eigenvalues) Q^T of a symmetric matrix, overwriting A with Q
+void GP::symmetricEigen(Matrix & A, Vector & eigenvalues, Backend backend)
+{
+  auto n = static_cast<int>(A.rows());
+#ifdef GP_USE_LAPACKE
+  if ( backend == Backend::Lapacke )
+    {
+      eigenvalues.resize(n);
+      LAPACKE_dsyevd(LAPACK_COL_MAJOR, 'V', 'L', static_cast<lapack_int>(n), A.data(), static_cast<lapack_int>(A.outerStride()), eigenvalues.data());
+      return;
+    }
+#endif
+  (void)n;
+  Eigen::SelfAdjointEigenSolver<Matrix> solver(A, Eigen::ComputeEigenvectors);
+  eigenvalues = solver.eigenvalues();
+  A = solver.eigenvectors();
+}
+
+// Invert a symmetric positive definite matrix K = L*L^T in two blocked, multi-threaded passes:
+//
+//   1)  W = L^-1       [ column blocks are independent:  W(j:n,J) = L(j:n,j:n)^-1 * I(j:n,J) ]
+//   2)  K^-1 = W^T W   [ row block I:  K^-1(I,0:i) = W(i:n,I)^T * W(i:n,0:i), formed in place from the top down ]
+//
+// [ This requires n^3/3 multiply-adds, compared to n^3 for two full triangular solves against the identity ]
+template <typename MatrixType>
+static void spdInverseImpl(const MatrixType & L, MatrixType & Kinv, int blockSize, GP::Backend backend)
+{
+  using Buffer = BlockBuffer<typename MatrixType::Scalar>;
+  auto n = static_cast<int>(L.rows());
+#ifdef GP_USE_LAPACKE
+  if ( backend == GP::Backend::Lapacke )
+    {
+      Kinv = L;
+      lapackPotri(n, Kinv.data(), static_cast<lapack_int>(Kinv.outerStride()));
+      return;
+    }
+#endif
+  int nb = std::max(1, std::min(blockSize, SPD_MAX_BLOCK));
+  Kinv.resize(n,n);
+
+  if ( &L != &Kinv )
+    {
+      // Invert the triangular factor; the largest trailing solves are claimed first
+      GP::threadPool().parallelFor(0, n, nb, [&](int startCol, int endCol) {
+                                               for ( int j0 = startCol; j0 < endCol; j0 += nb )
+                                                 {
+                                                   int m = n - j0;
+                                                   auto W = Kinv.block(j0, j0, m, std::min(nb, endCol-j0));
+                                                   W.setIdentity();
+                                                   L.block(j0, j0, m, m).template triangularView<Eigen::Lower>().solveInPlace(W);
+                                                 }
+                                             });
+    }
+  else
+    {
+      // Invert the triangular factor in place from the bottom-right block upwards  [ equivalent to LAPACK trtri ]
+      //
+      //   W(t:n,J)  =  - W(t:n,t:n) * L(t:n,J) * L(J,J)^-1     [ t = end of block column J; W(t:n,t:n) is already inverted ]
+      //
+      // [ The panel L(t:n,J) is staged, transposed, in the unused strict upper triangle so that row blocks can be updated in parallel ]
+      for ( int j = ((n-1)/nb)*nb; j >= 0; j -= nb )
+        {
+          int jb = std::min(nb, n - j);
+          int t = j + jb;
+          int m = n - t;
+          auto Ljj = Kinv.block(j, j, jb, jb);
+          if ( m > 0 )
+            {
+              auto Pt = Kinv.block(j, t, jb, m);
+              Pt = Kinv.block(t, j, m, jb).transpose();
+              GP::threadPool().parallelFor(0, m, nb, [&](int startRow, int endRow) {
+                                                       for ( int r0 = startRow; r0 < endRow; r0 += nb )
+                                                         {
+                                                           int rb = std::min(nb, endRow-r0);
+                                                           Buffer T(rb, jb);
+                                                           T.noalias() = Kinv.block(t+r0, t+r0, rb, rb).template triangularView<Eigen::Lower>() * Pt.block(0, r0, jb, rb).transpose();
+                                                           if ( r0 > 0 )
+                                                             T.noalias() += Kinv.block(t+r0, t, rb, r0) * Pt.block(0, 0, jb, r0).transpose();
+                                                           Ljj.template triangularView<Eigen::Lower>().template solveInPlace<Eigen::OnTheRight>(T);
+                                                           Kinv.block(t+r0, j, rb, jb) = -T;
+                                                         }
+                                                     });
+            }
+          Buffer T = Buffer::Identity(jb, jb);
+          Ljj.template triangularView<Eigen::Lower>().solveInPlace(T);
+          Ljj.template triangularView<Eigen::Lower>() = T;
+        }
+    }
+
+  // Form W^T W one row block at a time [ later row blocks only read rows of W below the current block ]
+  for ( int i = 0; i < n; i += nb )
+    {
+      int ib = std::min(nb, n - i);
+      int m = n - i;
+      auto Wi = Kinv.block(i, i, m, ib);
+      Kinv.block(i, i, ib, ib).template triangularView<Eigen::StrictlyUpper>().setZero();
+
+      // Blocks left of the diagonal only read/write their own columns
+      GP::threadPool().parallelFor(0, i, nb, [&](int startCol, int endCol) {
+                                               for ( int c0 = startCol; c0 < endCol; c0 += nb )
+                                                 {
+                                                   int cb = std::min(nb, endCol-c0);
+                                                   Buffer T(ib, cb);
+                                                   T.noalias() = Wi.transpose() * Kinv.block(i, c0, m, cb);
+                                                   Kinv.block(i, c0, ib, cb) = T;
+                                                 }
+                                             });
+
+      Buffer T(ib, ib);
+      T.noalias() = Wi.transpose() * Wi;
+      Kinv.block(i, i, ib, ib) = T;
+    }
+}
+
+void GP::spdInverse(const Matrix & L, Matrix & Kinv, int blockSize, Backend backend) { spdInverseImpl(L, Kinv, blockSize, backend); }
+void GP::spdInverse(const MatrixF & L, MatrixF & Kinv, int blockSize, Backend backend) { spdInverseImpl(L, Kinv, blockSize, backend); }
+
+
+// Parse kernel parameter vector, separating noise and scaling from the kernel hyperparameters
+// [ The kernel hyperparameters are the trailing 'paramCount' entries of params ]
+void GP::Kernel::parseParams(const Vector & params, double & noise, double & scaling)
+{
+  if ( !fixedNoise )
+    {
+      // Noise = params(0)
+      noise = params(0);
+      scaling = ( !fixedScaling ) ? params(1) : scalingLevel;
+    }
+  else
+    {
+      // Scaling = params(0)
+      noise = noiseLevel;
+      scaling = ( !fixedScaling ) ? params(0) : scalingLevel;
+    }
+}
+
+// Compute the lower triangle of the covariance matrix column by column in cache-sized segments
+// [ Kernel values are evaluated in double precision and rounded on store in single precision, where values which
+//   would be subnormal are flushed to zero (subnormal operands slow down the factorization by orders of magnitude) ]
+template <typename MatrixType>
+void GP::Kernel::covLower(MatrixType & K, const DistanceView & D, Vector & params, double jitter)
+{
+  using Scalar = typename MatrixType::Scalar;
+  const double minValue = std::is_same<Scalar,float>::value ? std::numeric_limits<float>::min() : 0.0;
+  auto n = D.size();
+  double noise, scaling;
+  parseParams(params, noise, scaling);
+  auto kernelParams = params.tail(paramCount);
+  K.resize(n,n);
+
+  const int segment = 256;
+  threadPool().parallelFor(0, n, 16, [&](int startCol, int endCol) {
+                                       double dist[segment];
+                                       double vals[segment];
+                                       for ( auto j : boost::irange(startCol, endCol) )
+                                         {
+                                           for ( int r0 = j; r0 < n; r0 += segment )
+                                             {
+                                               int len = std::min(segment, n - r0);
+                                               Scalar * k = K.data() + static_cast<std::size_t>(j)*n + r0;
+                                               evalDistKernel(D.segment(j, r0, len, dist), vals, len, kernelParams, 0);
+                                               for ( auto r : boost::irange(0,len) )
+                                                 {
+                                                   double v = vals[r]*scaling;
+                                                   k[r] = ( std::abs(v) >= minValue ) ? static_cast<Scalar>(v) : Scalar(0);
+                                                 }
+                                             }
+
+                                           // Make sure not to scale the jitter and noise terms
+                                           K(j,j) = static_cast<Scalar>(scaling*1.0 + jitter + noise);
+                                         }
+                                     });
+}
+
+void GP::Kernel::computeCovLower(Matrix & K, const DistanceView & D, Vector & params, double jitter) { covLower(K, D, params, jitter); }
+void GP::Kernel::computeCovLower(MatrixF & K, const DistanceView & D, Vector & params, double jitter) { covLower(K, D, params, jitter); }
+
+
+// Compute Y = K*X one row of Y at a time from the corresponding (full) column of K
+// [ Each task only writes its own rows of Y, so no reduction is required ]
+double GP::Kernel::applyCov(const DistanceView & D, Vector & params, double jitter, const Matrix & X, Matrix & Y)
+{
+  auto n = D.size();
+  auto m = static_cast<int>(X.cols());
+  double noise, scaling;
+  parseParams(params, noise, scaling);
+  auto kernelParams = params.tail(paramCount);
+  Y.resize(n,m);
+
+  const int segment = 256;
+  std::atomic<double> maxNorm{0.0};
+  threadPool().parallelFor(0, n, 16, [&](int startCol, int endCol) {
+                                       double dist[segment];
+                                       double k[segment];
+                                       double norm = 0.0;
+                                       for ( auto j : boost::irange(startCol, endCol) )
+                                         {
+                                           Y.row(j).setZero();
+                                           double colSum = 0.0;
+                                           for ( int r0 = 0; r0 < n; r0 += segment )
+                                             {
+                                               int len = std::min(segment, n - r0);
+                                               evalDistKernel(D.segment(j, r0, len, dist), k, len, kernelParams, 0);
+                                               for ( auto r : boost::irange(0,len) )
+                                                 k[r] *= scaling;
+                                               if ( j >= r0 && j < r0 + len )
+                                                 k[j-r0] = scaling*1.0 + jitter + noise;
+                                               Eigen::Map<const Vector> kseg(k, len);
+                                               Y.row(j).noalias() += kseg.transpose() * X.middleRows(r0, len);
+                                               colSum += kseg.cwiseAbs().sum();
+                                             }
+                                           norm = std::max(norm, colSum);
+                                         }
+
+                                       double current = maxNorm;
+                                       while ( norm > current && !maxNorm.compare_exchange_weak(current, norm) ) { }
+                                     });
+
+  return maxNorm;
+}
+
+
+// Compute gradient traces for all kernel hyperparameters in one sweep over the lower triangle of term
+//
+//   trace[ term * dK_i ]  =  sum_jk term(j,k) * scaling * dk_i(D(j,k))
+//
+// [ term and dK_i are symmetric, so off-diagonal entries are counted twice; sums are accumulated in double precision ]
+// [ traces are formed for the 'count' kernel derivatives starting at derivative index 'first' ]
+template <typename MatrixType>
+void GP::Kernel::gradTraces(const MatrixType & term, const DistanceView & D, Vector & params, Vector & traces, std::vector<double> & partials,
+                            int first, int count)
+{
+  using Scalar = typename MatrixType::Scalar;
+  auto n = D.size();
+  double noise, scaling;
+  parseParams(params, noise, scaling);
+  auto kernelParams = params.tail(paramCount);
+
+  // Each chunk of columns accumulates into its own cache-line aligned block of partial sums (avoids false sharing)
+  const int chunk = 16;
+  const int segment = 256;
+  const int stride = ( (count + 7)/8 ) * 8;
+  int chunkCount = (n + chunk - 1)/chunk;
+  partials.assign(static_cast<std::size_t>(chunkCount)*stride, 0.0);
+
+  threadPool().parallelFor(0, n, chunk, [&](int startCol, int endCol) {
+                                          double * acc = partials.data() + static_cast<std::size_t>(startCol/chunk)*stride;
+                                          double dK[segment];
+                                          double dist[segment];
+                                          for ( auto j : boost::irange(startCol, endCol) )
+                                            {
+                                              // Process column j below the diagonal in cache-sized segments
+                                              for ( int r0 = j; r0 < n; r0 += segment )
+                                                {
+                                                  int len = std::min(segment, n - r0);
+                                                  const double * d = D.segment(j, r0, len, dist);
+                                                  const Scalar * t = term.data() + static_cast<std::size_t>(j)*n + r0;
+                                                  for ( auto i : boost::irange(0,count) )
+                                                    {
+                                                      evalDistKernel(d, dK, len, kernelParams, first+i);
+                                                      double sum = 0.0;
+                                                      for ( auto r : boost::irange(0,len) )
+                                                        sum += t[r]*dK[r];
+                                                      sum *= 2.0;
+                                                      if ( r0 == j )
+                                                        sum -= t[0]*dK[0];
+                                                      acc[i] += sum;
+                                                    }
+                                                }
+                                            }
+                                        });
+
+  traces.setZero(count);
+  for ( auto c : boost::irange(0,chunkCount) )
+    for ( auto i : boost::irange(0,count) )
+      traces(i) += partials[static_cast<std::size_t>(c)*stride + i];
+  traces *= scaling;
+}
+
+void GP::Kernel::computeGradTraces(const Matrix & term, const DistanceView & D, Vector & params, Vector & traces, std::vector<double> & partials) { gradTraces(term, D, params, traces, partials, 1, paramCount); }
+void GP::Kernel::computeGradTraces(const MatrixF & term, const DistanceView & D, Vector & params, Vector & traces, std::vector<double> & partials) { gradTraces(term, D, params, traces, partials, 1, paramCount); }
+void GP::Kernel::computeHessTraces(const Matrix & term, const DistanceView & D, Vector & params, Vector & traces, std::vector<double> & partials) { gradTraces(term, D, params, traces, partials, paramCount+1, paramCount*paramCount); }
+
+
+// Compute the derivative matrices  dK_i = scaling * dk_i(D)  of all kernel hyperparameters from the dense distance matrix
+void GP::Kernel::computeCovDerivatives(std::vector<Matrix> & dK, const Matrix & D, Vector & params)
+{
+  double noise, scaling;
+  parseParams(params, noise, scaling);
+  auto kernelParams = params.tail(paramCount);
+  auto n = static_cast<int>(D.rows());
+
+  dK.resize(paramCount);
+  for ( auto i : boost::irange(0,paramCount) )
+    {
+      Matrix & dKi = dK[i];
+      dKi.resize(n,n);
+      threadPool().parallelFor(0, n, 64, [&](int startCol, int endCol) {
+                                           auto offset = static_cast<std::size_t>(startCol)*n;
+                                           auto count = static_cast<std::size_t>(endCol-startCol)*n;
+                                           evalDistKernel(D.data()+offset, dKi.data()+offset, count, kernelParams, i+1);
+                                         });
+      dKi *= scaling;
+    }
+}
+
+
+// Compute covariance matrix from the dense matrix of squared pairwise distances
+void GP::RBF::computeCov(Matrix & K, const Matrix & D, Vector & params, double jitter)
+{
+  // Separate noise and scaling parameters from kernel hyperparameters
+  double noise, scaling;
+  parseParams(params, noise, scaling);
+  
+  // Evaluate covariance kernel elementwise on the distance matrix
+  auto n = static_cast<int>(D.rows());
+  double lengthScale2 = std::pow(params.tail(paramCount)(0),2);
+  K.resize(n,n);
+  threadPool().parallelFor(0, n, 64, [&](int startCol, int endCol) {
+                                       auto offset = static_cast<std::size_t>(startCol)*n;
+                                       auto count = static_cast<std::size_t>(endCol-startCol)*n;
+                                       vexp(D.data()+offset, K.data()+offset, count, -0.5/lengthScale2, scaling);
+                                     });
+
+  // Make sure not to scale the jitter and noise terms
+  K.diagonal().setConstant(scaling*1.0 + jitter + noise);
+
+};
+
+
+// Define distance kernel function for RBF
+// [ Note: Optimize w.r.t. theta = log(l) for stability  ==>   / l^2  instead of  / l^3 ]
+double GP::RBF::evalDistKernel(double d, Vector & params, int n)
+{
+  switch (n)
+    {
+    case 0: return std::exp( -d / (2.0*std::pow(params(0),2)));
+    case 1: return d / std::pow(params(0),2) * std::exp( -d / (2.0*std::pow(params(0),2)));
+    case 2: return d / std::pow(params(0),2) * ( d / std::pow(params(0),2) - 2.0 ) * std::exp( -d / (2.0*std::pow(params(0),2)));
+    default: std::cout << "\n[*] UNDEFINED DERIVATIVE\n"; return 0.0;
+    }
+};
+
+
+// Evaluate the RBF kernel (n=0) or its first (n=1) and second (n=2) log-lengthscale derivatives on an array of squared distances
+void GP::RBF::evalDistKernel(const double * d, double * k, std::size_t count, const Eigen::Ref<const Vector> & params, int n)
+{
+  double lengthScale2 = std::pow(params(0),2);
+  switch (n)
+    {
+    case 0: vexp(d, k, count, -0.5/lengthScale2); break;
+    case 1:
+      {
+        vexp(d, k, count, -0.5/lengthScale2, 1.0/lengthScale2);
+        for ( std::size_t i = 0; i < count; i++ )
+          k[i] *= d[i];
+        break;
+      }
+    case 2:
+      {
+        vexp(d, k, count, -0.5/lengthScale2, 1.0/lengthScale2);
+        for ( std::size_t i = 0; i < count; i++ )
+          k[i] *= d[i] * ( d[i]/lengthScale2 - 2.0 );
+        break;
+      }
+    default: std::cout << "\n[*] UNDEFINED DERIVATIVE\n"; std::fill(k, k+count, 0.0);
+    }
+};
+
+
+// Compute cross covariance between two input vectors using kernel parameters params
+void GP::RBF::computeCrossCov(Matrix & K, Matrix & X1, Matrix & X2, Vector & params)
+{
+  // Compute squared distances and evaluate the kernel in place
+  sqDist(K, X1, X2);
+  auto m = static_cast<std::size_t>(K.rows());
+  threadPool().parallelFor(0, static_cast<int>(K.cols()), 64, [&](int startCol, int endCol) {
+                                                               double * k = K.data() + startCol*m;
+                                                               evalDistKernel(k, k, (endCol-startCol)*m, params, 0);
+                                                             });
+};
+
+
+// Subtract alpha*alpha^T from the lower triangle of K^-1 to form the gradient term
+template <typename MatrixType>
+static void formGradTerm(MatrixType & term, const GP::Matrix & alpha)
+{
+  using Scalar = typename MatrixType::Scalar;
+  auto n = static_cast<int>(alpha.rows());
+  GP::threadPool().parallelFor(0, n, 64, [&term,&alpha,n](int startCol, int endCol) {
+                                           for ( auto j : boost::irange(startCol,endCol) )
+                                             term.col(j).tail(n-j) -= ( alpha(j,0) * alpha.col(0).tail(n-j) ).template cast<Scalar>();
+                                         });
+}
+
+
+// Solve K alpha = y to double precision using the single precision factor in ws.Kf  [ mixed precision iterative refinement ]
+//
+//   alpha_0 = (Lf Lf^T)^-1 y;    r_k = y - K alpha_k  (double);    alpha_k+1 = alpha_k + (Lf Lf^T)^-1 r_k
+//
+// [ Stops once  ||r||_inf <= sqrt(n) * eps * ||K||_inf * ||alpha||_inf  (as in LAPACK dsposv).  Each step contracts the
+//   residual by roughly cond(K) * eps_float, which also bounds the accuracy of the single precision log-determinant; so
+//   this returns false (fall back to double) if any step reduces the residual by less than 100x ]
+bool GP::GaussianProcess::refineAlpha(Workspace & ws, Vector & params)
+{
+  const int maxIterations = 10;
+  const double maxContraction = 1e-2;
+  auto n = static_cast<int>(obsY.rows());
+  auto Lf = ws.Kf.triangularView<Eigen::Lower>();
+  auto solveF = [&ws,&Lf]() {
+                  Lf.solveInPlace(ws.correction);
+                  Lf.transpose().solveInPlace(ws.correction);
+                };
+
+  ws.correction = obsY.col(0).cast<float>();
+  solveF();
+  ws.alpha.col(0) = ws.correction.cast<double>();
+
+  double threshold = std::sqrt(static_cast<double>(n)) * std::numeric_limits<double>::epsilon();
+  double lastNorm = std::numeric_limits<double>::infinity();
+  for ( auto k : boost::irange(0,maxIterations) )
+    {
+      (void)k;
+      double normK = (*kernel).applyCov(distances(), params, jitter, ws.alpha, ws.residual);
+      ws.residual = obsY - ws.residual;
+      double norm = ws.residual.cwiseAbs().maxCoeff();
+      if ( norm <= threshold * normK * ws.alpha.cwiseAbs().maxCoeff() )
+        return true;
+      if ( !std::isfinite(norm) || norm > maxContraction*lastNorm )
+        return false;
+      lastNorm = norm;
+
+      ws.correction = ws.residual.col(0).cast<float>();
+      solveF();
+      ws.alpha.col(0) += ws.correction.cast<double>();
+    }
+  return false;
+}
+
+
+// Evaluate NLML for specified kernel hyperparameters p
+// [ All matrices are taken from the model workspace, so repeated evaluations do not allocate ]
+double GP::GaussianProcess::evalNLML(const Vector & p, Vector & g, bool evalGrad)
+{
+  time EVAL_start = high_resolution_clock::now();
+  
+  // Get matrix input observation count
+  auto n = static_cast<int>(obsX.rows());
+
+  // Return memoized results for repeated evaluations
+  if ( auto entry = evalCache.find(p, evalMode()) )
+    {
+      if ( !evalGrad || entry->hasGrad )
+        {
+          if ( evalGrad )
+            g = entry->grad;
+          profiledScale = entry->scale;
+          evalCache.hits += 1;
+          return entry->value;
+        }
+    }
+  functionEvals += 1;
+
+  // Size the workspace on first use (normally done once in fitModel)  [ a unit scaling level is inserted when profiling ]
+  Workspace & ws = workspace;
+  auto paramSize = static_cast<int>(p.size()) + ( profiling ? 1 : 0 );
+  if ( ( ws.alpha.rows() != n ) || ( ws.params.size() != paramSize ) )
+    ws.resize(n, paramSize, (*kernel).getParamCount(), lowMemory, mixedPrecision);
+
+  // ASSUME OPTIMIZATION OVER LOG VALUES
+  if ( profiling )
+    {
+      ws.params(0) = std::exp(p(0));
+      ws.params(1) = 1.0;
+      ws.params.tail(paramSize-2) = p.tail(paramSize-2).array().exp().matrix();
+    }
+  else
+    ws.params = p.array().exp().matrix();
+  ws.cacheValid = false;
+  Vector & params = ws.params;
+  Matrix & _alpha = ws.alpha;
+  if ( !lowMemory )
+    updateDistances();
+
+  // Attempt the single precision pipeline first  [ lower triangle of ws.Kf holds L ]
+  //  [ Subnormal single precision values arise in the factor and inverse when K is close to diagonal, so these are
+  //    flushed to zero; the thread pool inherits this mode, while Eigen's OpenMP threads run with their own ]
+  bool mixed = false;
+  time start, end;
+  FlushDenormals flush(mixedPrecision);
+  if ( mixedPrecision )
+    {
+      start = high_resolution_clock::now();
+      (*kernel).computeCovLower(ws.Kf, distances(), params, jitter);
+      end = high_resolution_clock::now();
+      time_computecov += getTime(start, end);
+
+      start = high_resolution_clock::now();
+      double scale = std::max(static_cast<double>(ws.Kf.diagonal().mean()), std::numeric_limits<double>::min());
+      mixed = choleskyFactor(ws.Kf, DEFAULT_BACKEND, tileSize, &ws.factorGraph);
+      end = high_resolution_clock::now();
+      time_cholesky_llt += getTime(start, end);
+
+      start = high_resolution_clock::now();
+      mixed = mixed && refineAlpha(ws, params);
+      end = high_resolution_clock::now();
+      time_alpha += getTime(start, end);
+
+      // Describe the single precision factorization  [ it is attempted once, without jitter escalation ]
+      if ( mixed )
+        {
+          auto pivots = ws.Kf.diagonal().array().cast<double>();
+          factorInfo = CholeskyInfo();
+          factorInfo.success = true;
+          factorInfo.scale = scale;
+          factorInfo.attempts = 1;
+          factorInfo.rcond = std::pow(pivots.minCoeff() / pivots.maxCoeff(), 2);
+        }
+      else
+        {
+          mixedFallbacks += 1;
+          flush.restore();
+        }
+    }
+
+  if ( !mixed )
+    {
+      // Compute covariance matrix
+      start = high_resolution_clock::now();
+      if ( lowMemory )
+        (*kernel).computeCovLower(ws.K, distances(), params, jitter);
+      else
+        (*kernel).computeCov(ws.K, distMatrix(), params, jitter);
+      end = high_resolution_clock::now();
+      time_computecov += getTime(start, end);
+
+      // Factor the covariance matrix in place  [ lower triangle of ws.K holds L; jitter is escalated on failure ]
+      start = high_resolution_clock::now();
+      factorInfo = robustCholesky(ws.K, jitter, maxJitterAttempts, lowMemory, DEFAULT_BACKEND, tileSize, &ws.factorGraph, &ws.savedDiagonal);
+      end = high_resolution_clock::now();
+      time_cholesky_llt += getTime(start, end);
+      if ( factorInfo.attempts > 1 )
+        jitterEscalations += 1;
+
+      // Report an infinite NLML so that line searches back off immediately
+      if ( !factorInfo.success )
+        {
+          if ( evalGrad )
+            g.setZero();
+          time EVAL_end = high_resolution_clock::now();
+          time_evaluation += getTime(EVAL_start, EVAL_end);
+          return std::numeric_limits<double>::infinity();
+        }
+
+      start = high_resolution_clock::now();
+      _alpha = obsY;
+      choleskySolve(ws.K, _alpha);
+      end = high_resolution_clock::now();
+      time_alpha += getTime(start, end);
+    }
+  
+  // Compute NLML value
+  //  [ In mixed precision mode y^T alpha is refined to double precision, while the log-determinant
+  //    carries the (relative) accuracy of the single precision factor ]
+  start = high_resolution_clock::now();
+  double yTalpha = obsY.col(0).dot(_alpha.col(0));
+  double NLML_value = yTalpha;
+  NLML_value += n*std::log(2*PI);
+  NLML_value *= 0.5;
+  double logDet = mixed ? ws.Kf.diagonal().cast<double>().array().log().sum() : ws.K.diagonal().array().log().sum();
+  NLML_value += logDet;
+
+  // Profiled likelihood, minimized over the scaling level in closed form:
+  //
+  //   s* = y^T K~^-1 y / n,    NLML(s*) = n/2 ( 1 + log(2 pi s*) ) + 1/2 log|K~|
+  //
+  if ( profiling )
+    {
+      profiledScale = std::max(yTalpha/n, std::numeric_limits<double>::min());
+      NLML_value = 0.5*n*( 1.0 + std::log(2*PI*profiledScale) ) + logDet;
+    }
+  end = high_resolution_clock::now();
+  time_NLML += getTime(start, end);
+
+  // Memoize the value and keep the factorization for a subsequent gradient request at p  [ see gradient() ]
+  auto & entry = evalCache.insert(p, evalMode());
+  entry.value = NLML_value;
+  entry.scale = profiledScale;
+
+  ws.cachedParams = p;
+  ws.cachedMixed = mixed;
+  ws.cachedYTalpha = yTalpha;
+  ws.cachedJitter = ( mixed || ( factorInfo.scale <= 0 ) ) ? 0.0 : factorInfo.jitter / factorInfo.scale;
+  ws.cacheValid = true;
+
+  if ( evalGrad )
+    evalGradient(g);
+  
+  time EVAL_end = high_resolution_clock::now();
+  time_evaluation += getTime(EVAL_start, EVAL_end);
+  return NLML_value;
+  
+}
+
+
+// Evaluate the NLML gradient from the factorization left in the workspace by the last call to evalNLML
+// [ In low-memory mode the factor is overwritten by the gradient term, so the workspace cache is consumed ]
+void GP::GaussianProcess::evalGradient(Vector & g)
+{
+  auto n = static_cast<int>(obsX.rows());
+  Workspace & ws = workspace;
+  Vector & params = ws.params;
+  Matrix & _alpha = ws.alpha;
+  bool mixed = ws.cachedMixed;
+  double yTalpha = ws.cachedYTalpha;
+  time start, end;
+
+  //
+  // Precompute the multiplicative term in derivative expressions
+  //
+  // [ THIS APPEARS TO BE A COMPUTATIONAL BOTTLE-NECK ]
+  //
+
+  
+  start = high_resolution_clock::now();
+  
+  // Direct Implementation
+  //Matrix term(n,n);
+  //term.noalias() = _cholesky.solve(Matrix::Identity(n,n));
+  //term.noalias() -= _alpha*_alpha.transpose();
+
+  // Using Solve In Place
+  //Matrix term = Matrix::Identity(n,n);
+  //_cholesky.solveInPlace(term);
+  //term.noalias() -= _alpha*_alpha.transpose();
+
+  
+  //
+  //  MULTI-THREADED IMPLEMENTATION
+  //
+  //  [ Blocked SPD inverse from the Cholesky factor; only the lower triangle of term is formed ]
+  //  [ In low-memory mode the inverse overwrites the factor in place ]
+  //
+  //  [ The profiled gradient is  1/2 trace[ (K~^-1 - alpha*alpha^T / s*) dK~ ],  so alpha is rescaled in place ]
+  //
+  if ( profiling )
+    _alpha /= std::sqrt(profiledScale);
+
+  double termTrace;
+  if ( mixed )
+    {
+      MatrixF & term = lowMemory ? ws.Kf : ws.termF;
+      spdInverse(ws.Kf, term);
+      formGradTerm(term, _alpha);
+      termTrace = term.diagonal().cast<double>().sum();
+      end = high_resolution_clock::now();
+      time_term += getTime(start, end);
+
+      start = high_resolution_clock::now();
+      (*kernel).computeGradTraces(term, distances(), params, ws.traces, ws.traceVals);
+    }
+  else
+    {
+      Matrix & term = lowMemory ? ws.K : ws.term;
+      spdInverse(ws.K, term);
+      formGradTerm(term, _alpha);
+      termTrace = term.trace();
+      end = high_resolution_clock::now();
+      time_term += getTime(start, end);
+
+      // Compute gradients with respect to kernel hyperparameters in a single fused sweep over term
+      //  [ the derivative matrices dK_i are never formed explicitly ]
+      start = high_resolution_clock::now();
+      (*kernel).computeGradTraces(term, distances(), params, ws.traces, ws.traceVals);
+    }
+
+  // Compute gradient for noise term if 'fixedNoise=false'
+  //
+  // The factored matrix is  K = s*K0 + (noise + jitter + e)*I,  where the escalated jitter  e = r*(s + noise + jitter)  is
+  // proportional to the mean diagonal for the number of attempts of the factorization  [ r = ws.cachedJitter ], so that
+  //
+  //   de/dlog(noise) = r*noise,    de/dlog(s) = r*s
+  //
+  int index = 0;
+  double noise = ( !fixedNoise ) ? params(0) : noiseLevel;
+  double escalation = 1.0 + ws.cachedJitter;
+  if (!fixedNoise)
+    {
+      // Specify gradient of white noise kernel  [ dK_i = (1 + r)*params(0)*Matrix::Identity(n,n) ]
+      //g(index++) = 0.5 * (term * params(0)).trace() ;
+      g(index++) = 0.5 * escalation * noise * termTrace;
+    }
+
+  
+  if ( !fixedScaling && !profiling )
+    {
+      // Since  dK/dlog(s) = s*K0 + r*s*I = K - (1 + r)*(noise + jitter)*I  and  trace[term*K] = n - y^T alpha :
+      //
+      //   1/2 * trace[ term * dK/dlog(s) ]  =  1/2 * ( n - y^T alpha - (1 + r)*(noise + jitter) * trace[term] )
+      //
+      // [ This avoids forming K - (noise + jitter)*I, since K has been overwritten by its Cholesky factor ]
+      g(index++) = 0.5 * ( n - yTalpha - escalation * (noise + jitter) * termTrace );
+
+      //  
+      //  NOTE: The following implementation does not account for noise term (!)
+      //
+      //  Ah, it's so close though...
+      //
+      //  The adjusted covariance matrix is:  K'  =  s * K  +  noise * I  
+      //
+      //  But if we had   K' = s*K   and set   t = log(s) ~ s = exp(t) :
+      //
+      //  ( so that  dK'/dt  =  d/dt[ s*K ]  =  d/ds[ s*K ] * ds/dt  =  s * K  =  K'  )
+      //
+      //  then it would give us the reduction:
+      //
+      //  d/dt -log p(y|X,t)  =  -1/2 * trace[ ( (K'^-1 y)(K'^-1 y)^T - K'^-1 ) dK'/dt  ]
+      //
+      //   =  -1/2 * trace[ ( K'^-1 y y^T K'^-1 - K'^-1 ) dK'/dt  ]
+      //
+      //   =  -1/2 * trace[ ( K'^-1 y y^T K'^1 - K'^-1 ) K'  ]
+      //
+      //   =  -1/2 * trace[  (K'^-1 y) y^T - I  ]
+      //
+      //   =  -1/2 * trace[  alpha * y^T - I  ]
+      //
+      //
+      //  but...    we do have:
+      //  
+      //   dK'/dt  =  d/dt[s*K]  =  s * K  =  K' - noise * I
+      //
+      //  so that the (corected) calculation above still yields:
+      //
+      //   =  -1/2 * trace[  (alpha * y^T - I)  -  noise * term  ]
+      //
+      //  and the trace of "term" has already been calculated...
+      //
+    }
+
+  for ( auto i : boost::irange(0,static_cast<int>(ws.traces.size())) )
+    g(index++) = 0.5*ws.traces(i);
+  
+  end = high_resolution_clock::now();
+  time_grad += getTime(start, end);
+
+  // Update gradient evaluation count
+  gradientEvals += 1;
+
+  // Memoize the gradient  [ the factor is kept for reuse unless it has been overwritten by the gradient term ]
+  if ( auto entry = evalCache.find(ws.cachedParams, evalMode()) )
+    {
+      entry->grad = g;
+      entry->hasGrad = true;
+    }
+  if ( profiling )
+    _alpha *= std::sqrt(profiledScale);
+  ws.cacheValid = !lowMemory;
+}
+
+
+// Value-only evaluation used for line search trial points  [ the factorization is kept for a subsequent gradient() call ]
+double GP::GaussianProcess::value(const Vector & p)
+{
+  Vector nullGrad(0);
+  return fixedParams ? evalSpectralNLML(p, nullGrad, false) : evalNLML(p, nullGrad, false);
+}
+
+
+// Evaluate the gradient at p, reusing the factorization from value(p) when p was the last point evaluated
+void GP::GaussianProcess::gradient(const Vector & p, Vector & g)
+{
+  if ( fixedParams )
+    {
+      evalSpectralNLML(p, g, true);
+      return;
+    }
+  Workspace & ws = workspace;
+  if ( ws.cacheValid && ( ws.cachedParams.size() == p.size() ) && ( ws.cachedParams == p ) )
+    {
+      time EVAL_start = high_resolution_clock::now();
+      FlushDenormals flush(ws.cachedMixed);
+      evalGradient(g);
+      time EVAL_end = high_resolution_clock::now();
+      time_evaluation += getTime(EVAL_start, EVAL_end);
+    }
+  else
+    evalNLML(p, g, true);
+}
+
+
+// Signal that a restart has been abandoned  [ not a runtime_error, so that solver failures are handled separately ]
+namespace { struct AbandonRestart : std::exception { }; }
+
+// Share the best NLML of this restart with the other restarts, and abandon this restart if it trails them by more than the margin
+//  [ only accepted iterates count, so that the extended and rejected trial points of a line search neither advance the
+//    iteration count nor lower the best value ]
+void GP::GaussianProcess::iteration(const Vector & p, double fx)
+{
+  if ( !restartBoard )
+    return;
+  if ( ( restartIterations == 0 ) || ( fx < restartBestValue ) )
+    {
+      restartBestValue = fx;
+      restartBestParams = p;
+    }
+  restartIterations += 1;
+
+  double others = std::numeric_limits<double>::infinity();
+  {
+    std::lock_guard<std::mutex> lock(restartBoard->mutex);
+    restartBoard->best[restartIndex] = restartBestValue;
+    for ( auto j : boost::irange(0, static_cast<int>(restartBoard->best.size())) )
+      if ( j != restartIndex )
+        others = std::min(others, restartBoard->best[j]);
+  }
+  if ( ( abandonIterations > 0 ) && ( restartIterations >= abandonIterations ) && ( restartBestValue > others + abandonMargin * std::max(1.0, std::abs(others)) ) )
+    throw AbandonRestart();
+}
+
+
+// Configure this model to evaluate the NLML of 'model' during a concurrent restart
+//  [ the kernel and the distance matrix are shared read-only; each model has its own workspace and cache ]
+void GP::GaussianProcess::shareModel(GaussianProcess & model)
+{
+  kernel = model.kernel;
+  obsX = model.obsX;
+  obsY = model.obsY;
+  sharedDist = model.lowMemory ? nullptr : &model.obsDist;
+  distStale = model.lowMemory;
+  noiseLevel = model.noiseLevel;
+  fixedNoise = model.fixedNoise;
+  scalingLevel = model.scalingLevel;
+  fixedScaling = model.fixedScaling;
+  jitter = model.jitter;
+  maxJitterAttempts = model.maxJitterAttempts;
+  tileSize = model.tileSize;
+  lowMemory = model.lowMemory;
+  mixedPrecision = model.mixedPrecision;
+  profiling = model.profiling;
+  profiledScaling = model.profiledScaling;
+  abandonIterations = model.abandonIterations;
+  abandonMargin = model.abandonMargin;
+  optimizer = model.optimizer;
+  lineSearchBudget = model.lineSearchBudget;
+  evalCache.clear();
+}
+
+
+// Compute the Fisher information and the observed information (Hessian of the NLML) of the log-hyperparameters at the point
+// of the last gradient evaluation g
+//
+//   F_ij  =  1/2 trace[ K^-1 dK_i K^-1 dK_j ],    K^-1  =  term + alpha*alpha^T
+//
+//   H_ij  =  alpha^T dK_i K^-1 dK_j alpha  -  F_ij  +  1/2 trace[ term * d^2K/dlog(theta_i)dlog(theta_j) ]
+//
+// [ Since  dK/dlog(noise) = a*I  and  dK/dlog(s) = K - b*I  ( a = (1 + r)*noise,  b = (1 + r)*(noise + jitter),  with the
+//   relative escalated jitter r of evalGradient ),  only the kernel hyperparameters require products  P_k = K^-1 dK_k;  the noise and
+//   scaling entries of F follow from trace[K^-1], trace[K^-1 K^-1], trace[P_k] and trace[K^-1 P_k], and their second
+//   derivatives reduce to first derivatives, whose traces are given by g ]
+void GP::GaussianProcess::evalInformation(const Vector & g, Matrix & fisher, Matrix & hessian)
+{
+  auto n = static_cast<int>(obsX.rows());
+  Workspace & ws = workspace;
+  Vector & params = ws.params;
+  double noise = ( !fixedNoise ) ? params(0) : noiseLevel;
+  auto p = static_cast<int>(g.size());
+  int kernelCount = (*kernel).getParamCount();
+  int kernelIndex = p - kernelCount;
+  int noiseIndex = fixedNoise ? -1 : 0;
+  int scaleIndex = fixedScaling ? -1 : ( fixedNoise ? 0 : 1 );
+  double noiseDeriv = ( 1.0 + ws.cachedJitter ) * noise;
+  double shift = ( 1.0 + ws.cachedJitter ) * ( noise + jitter );
+
+  ws.inverse = ws.term.selfadjointView<Eigen::Lower>();
+  ws.inverse.noalias() += ws.alpha * ws.alpha.transpose();
+
+  // Form  dK_i alpha  and  P_k = K^-1 dK_k  [ dK/dlog(s) alpha = y - b*alpha ]
+  ws.dKalpha.resize(n,p);
+  if ( noiseIndex >= 0 )
+    ws.dKalpha.col(noiseIndex) = noiseDeriv * ws.alpha.col(0);
+  if ( scaleIndex >= 0 )
+    ws.dKalpha.col(scaleIndex) = obsY.col(0) - shift * ws.alpha.col(0);
+  (*kernel).computeCovDerivatives(ws.derivs, distMatrix(), params);
+  ws.products.resize(kernelCount);
+  for ( auto k : boost::irange(0,kernelCount) )
+    {
+      ws.products[k].noalias() = ws.inverse * ws.derivs[k];
+      ws.dKalpha.col(kernelIndex+k).noalias() = ws.derivs[k] * ws.alpha.col(0);
+    }
+
+  // Kernel entries  trace[ A B ] = sum_jk A(j,k) B(k,j)
+  for ( auto i : boost::irange(0,kernelCount) )
+    for ( auto j : boost::irange(0,i+1) )
+      fisher(kernelIndex+i,kernelIndex+j) = fisher(kernelIndex+j,kernelIndex+i)
+        = 0.5 * ws.products[i].cwiseProduct(ws.products[j].transpose()).sum();
+
+  // Noise and scaling entries  [ with  P_noise = a*K^-1  and  P_s = I - b*K^-1;  trace[K^-1 P_k] = sum_jk K^-1(j,k) P_k(j,k)
+  //   since K^-1 is symmetric ]
+  double traceInverse = ws.inverse.trace();
+  double normInverse = ws.inverse.squaredNorm();
+  if ( noiseIndex >= 0 )
+    fisher(noiseIndex,noiseIndex) = 0.5 * noiseDeriv * noiseDeriv * normInverse;
+  if ( scaleIndex >= 0 )
+    fisher(scaleIndex,scaleIndex) = 0.5 * ( n - 2.0 * shift * traceInverse + shift * shift * normInverse );
+  if ( ( noiseIndex >= 0 ) && ( scaleIndex >= 0 ) )
+    fisher(noiseIndex,scaleIndex) = fisher(scaleIndex,noiseIndex) = 0.5 * noiseDeriv * ( traceInverse - shift * normInverse );
+  for ( auto k : boost::irange(0,kernelCount) )
+    {
+      double traceProduct = ws.products[k].trace();
+      double traceInverseProduct = ws.inverse.cwiseProduct(ws.products[k]).sum();
+      if ( noiseIndex >= 0 )
+        fisher(noiseIndex,kernelIndex+k) = fisher(kernelIndex+k,noiseIndex) = 0.5 * noiseDeriv * traceInverseProduct;
+      if ( scaleIndex >= 0 )
+        fisher(scaleIndex,kernelIndex+k) = fisher(kernelIndex+k,scaleIndex) = 0.5 * ( traceProduct - shift * traceInverseProduct );
+    }
+
+  ws.weighted.resize(n,p);
+  ws.weighted.noalias() = ws.inverse * ws.dKalpha;
+  hessian.noalias() = ws.dKalpha.transpose() * ws.weighted;
+  hessian -= fisher;
+
+  // Second derivative terms  [ d^2K/dlog(noise)^2 = dK/dlog(noise),  d^2K/dlog(s)dlog(theta_j) = dK/dlog(theta_j) ]
+  if ( noiseIndex >= 0 )
+    hessian(noiseIndex,noiseIndex) += g(noiseIndex);
+  if ( scaleIndex >= 0 )
+    {
+      for ( auto j : boost::irange(scaleIndex,p) )
+        {
+          hessian(scaleIndex,j) += g(j);
+          if ( j != scaleIndex )
+            hessian(j,scaleIndex) += g(j);
+        }
+    }
+  (*kernel).computeHessTraces(ws.term, distances(), params, ws.hessTraces, ws.traceVals);
+  for ( auto i : boost::irange(0,kernelCount) )
+    for ( auto j : boost::irange(0,kernelCount) )
+      hessian(kernelIndex+i, kernelIndex+j) += 0.5 * ws.hessTraces(i*kernelCount + j);
+
+  fisherEvals += 1;
+}
+
+
+// Minimize the NLML by trust-region Fisher scoring within the bounds, stopping on the projected gradient (epsilon),
+// the relative reduction of accepted steps (delta, when past > 0) or the iteration limit of the solver parameters
+//  [ each iteration costs one value evaluation; accepted steps add a gradient and an information evaluation ]
+int GP::GaussianProcess::minimizeFisher(Vector & theta, double & fx, const Vector & lbs, const Vector & ubs, const SolverOptions & options)
+{
+  Workspace & ws = workspace;
+  auto p = static_cast<int>(theta.size());
+  Vector g(p), step(p), trial(p);
+  Matrix F(p,p), H(p,p);
+  theta = theta.cwiseMax(lbs).cwiseMin(ubs);
+
+  // Evaluate the gradient and the curvature of the quadratic model at theta  [ a memoized gradient leaves the gradient term of another
+  //   point in the workspace, in which case theta is evaluated again ]
+  auto curvature = [&]() {
+                     gradient(theta, g);
+                     if ( !( ( ws.cachedParams.size() == p ) && ( ws.cachedParams == theta ) ) )
+                       {
+                         evalCache.erase(theta, evalMode());
+                         fx = evalNLML(theta, g, true);
+                       }
+                     evalInformation(g, F, H);
+                     if ( H.llt().info() == Eigen::Success )
+                       F = H;
+                   };
+  fx = value(theta);
+  if ( !std::isfinite(fx) )
+    throw std::runtime_error("the initial point of the Fisher scoring solver is not feasible");
+  curvature();
+
+  double radius = 1.0;
+  int iter = 0;
+  while ( iter < options.maxIterations )
+    {
+      if ( ( (theta - g).cwiseMax(lbs).cwiseMin(ubs) - theta ).lpNorm<Eigen::Infinity>() <= options.epsilon )
+        break;
+      iter += 1;
+
+      // Minimize the quadratic model  g^T s + 1/2 s^T F s  within the trust region  [ the step  -(F + lambda*I)^-1 g  is formed
+      //   in the eigenbasis of F, with the smallest lambda >= 0 for which it fits found by bisection; since ||s|| <= ||g||/lambda,
+      //   lambda = ||g||/radius always fits ]
+      Eigen::SelfAdjointEigenSolver<Matrix> eigen(F);
+      Vector gq = eigen.eigenvectors().transpose() * g;
+      Vector mu = eigen.eigenvalues().cwiseMax(1e-12 * std::max(1.0, eigen.eigenvalues().maxCoeff()));
+      auto scoringStep = [&](double lambda) { return static_cast<Vector>( -( eigen.eigenvectors() * ( gq.array() / ( mu.array() + lambda ) ).matrix() ) ); };
+      step = scoringStep(0.0);
+      if ( step.norm() > radius )
+        {
+          double lo = 0.0;
+          double hi = g.norm() / radius;
+          for ( int k = 0; ( k < 50 ) && ( hi - lo > 1e-3 * hi ); k++ )
+            {
+              double mid = 0.5*(lo + hi);
+              ( scoringStep(mid).norm() > radius ? lo : hi ) = mid;
+            }
+          step = scoringStep(hi);
+        }
+
+      // Compare the actual and predicted reductions at the trial point projected onto the bounds
+      trial = (theta + step).cwiseMax(lbs).cwiseMin(ubs);
+      step = trial - theta;
+      double predicted = -( g.dot(step) + 0.5 * step.dot(F * step) );
+      double ftrial = value(trial);
+      double ratio = ( ( predicted > 0.0 ) && std::isfinite(ftrial) ) ? ( fx - ftrial ) / predicted : -1.0;
+
+      double length = step.norm();
+      if ( ratio < 0.25 )
+        radius = 0.25 * length;
+      else if ( ( ratio > 0.75 ) && ( length > 0.99 * radius ) )
+        radius = std::min(2.0 * radius, 10.0);
+
+      if ( ratio > 1e-4 )
+        {
+          double reduction = fx - ftrial;
+          theta = trial;
+          fx = ftrial;
+          curvature();
+          iteration(theta, fx);
+          if ( ( options.past > 0 ) && ( reduction <= options.delta * std::max(1.0, std::abs(fx)) ) )
+            break;
+        }
+      else if ( radius < 1e-10 )
+        break;
+    }
+
+  return iter;
+}
+
+
+// Retrieve the name of a hyperparameter optimizer
+const char * GP::optimizerName(Optimizer optimizer)
+{
+  switch ( optimizer )
+    {
+    case Optimizer::LBFGS: return "L-BFGS";
+    case Optimizer::LBFGSB: return "L-BFGS-B";
+    case Optimizer::FisherScoring: return "Fisher scoring";
+    case Optimizer::ConjugateGradient: return "Conjugate gradients";
+    case Optimizer::CppOptLib: return "CppOptLib L-BFGS-B";
+    }
+  return "Unknown";
+}
+
+// Check whether an optimizer was compiled in
+bool GP::optimizerAvailable(Optimizer optimizer)
+{
+#ifdef GP_USE_CPPOPTLIB
+  return true;
+#else
+  return ( optimizer != Optimizer::CppOptLib );
+#endif
+}
+
+
+#ifdef GP_USE_CPPOPTLIB
+// Adapt an objective to the CppOptLib problem interface  [ the bounds are enforced by the L-BFGS-B solver ]
+class CppOptLibProblem : public cppoptlib::BoundedProblem<double>
+{
+public:
+  CppOptLibProblem(GP::Objective & f, const Vector & lbs, const Vector & ubs) : cppoptlib::BoundedProblem<double>(lbs, ubs), objective(f) { }
+  double value(const TVector & x) { return objective.value(x); }
+  void gradient(const TVector & x, TVector & grad) { objective.gradient(x, grad); }
+  bool callback(const cppoptlib::Criteria<double> &, const TVector & x) { objective.iteration(x, objective.value(x)); return true; }
+
+private:
+  GP::Objective & objective;
+};
+#endif
+
+
+// Minimize an objective by Polack-Ribiere conjugate gradients with Rasmussen's line search (minimize.m; see misc/minimize.cpp)
+//
+//   Trial steps are extrapolated (cubic, at most EXT times the current step) until the Wolfe-Powell conditions with
+//   SIG = 0.1 and RHO = SIG/2 are bracketed, and then interpolated (quadratic / cubic) within the bracket
+//
+// [ Every trial point requires the value and the gradient; a line search failing twice in a row ends the minimization.
+//   With a line search budget, BudgetLineSearch places value-only trial points under the weak Wolfe conditions instead ]
+static int conjugateGradient(GP::Objective & objective, Vector & X, double & f0, const GP::SolverOptions & options)
+{
+  const double SIG = 0.1;
+  const double RHO = SIG/2;
+  const double EXT = 3.0;
+  const double INT = 0.01;
+  const double RATIO = 100.0;
+  const double realmin = std::numeric_limits<double>::min();
+
+  auto N = X.size();
+  Vector df0(N), df3(N), X0(N), dF0(N);
+  f0 = objective(X, df0);
+
+  // Initial search direction (steepest descent) and step  1/(|s|+1)
+  Vector s = -df0;
+  double d0 = -s.dot(s);
+  double x3 = 1.0/(1.0 - d0);
+  bool lsFailed = false;
+
+  int i = 0;
+  while ( i < options.maxIterations )
+    {
+      i++;
+      X0 = X;
+      double F0 = f0;
+      dF0 = df0;
+      double f3 = f0, d3 = d0;
+      bool accepted = false;
+      if ( options.lineSearchBudget > 0 )
+        {
+          try
+            {
+              LBFGSpp::LBFGSParam<double> param;
+              param.ftol = RHO;
+              param.wolfe = SIG;
+              param.max_linesearch = std::min(options.maxLinesearch, options.lineSearchBudget);
+              GP::BudgetLineSearch<double>::LineSearch(objective, param, X0, s, std::numeric_limits<double>::infinity(),
+                                                        x3, f3, df3, d3, X);
+              accepted = true;
+            }
+          catch ( const std::runtime_error & )
+            {
+              // Keep a fallback point with s^T y <= 0 as the best point so far, and restart from steepest descent
+              if ( f3 < F0 )
+                {
+                  X0 = X;
+                  F0 = f3;
+                  dF0 = df3;
+                }
+              X = X0;
+            }
+        }
+      else
+        {
+          int M = options.maxLinesearch;
+
+          // Extrapolate  [ non-finite trial values are bisected towards the last point ]
+          double x1, f1, d1, x2, f2, d2;
+          double x4 = 0.0, f4 = 0.0, d4 = 0.0;
+          while ( true )
+            {
+              x2 = 0.0;
+              f2 = f0;
+              d2 = d0;
+              f3 = f0;
+              df3 = df0;
+              bool success = false;
+              while ( !success && ( M > 0 ) )
+                {
+                  M -= 1;
+                  f3 = objective(X + x3*s, df3);
+                  success = std::isfinite(f3) && df3.allFinite();
+                  if ( !success )
+                    x3 = 0.5*(x2 + x3);
+                }
+              if ( f3 < F0 )
+                {
+                  X0 = X + x3*s;
+                  F0 = f3;
+                  dF0 = df3;
+                }
+              d3 = df3.dot(s);
+              if ( ( d3 > SIG*d0 ) || ( f3 > f0 + x3*RHO*d0 ) || ( M == 0 ) )
+                break;
+
+              // Move point 2 to point 1 and point 3 to point 2, then extrapolate with the cubic through points 1 and 2
+              x1 = x2; f1 = f2; d1 = d2;
+              x2 = x3; f2 = f3; d2 = d3;
+              double A = 6*(f1 - f2) + 3*(d2 + d1)*(x2 - x1);
+              double B = 3*(f2 - f1) - (2*d1 + d2)*(x2 - x1);
+              double radical = B*B - A*d1*(x2 - x1);
+              x3 = ( radical >= 0.0 ) ? x1 - d1*(x2 - x1)*(x2 - x1)/( B + std::sqrt(radical) ) : -1.0;
+              if ( !std::isfinite(x3) || ( x3 < 0 ) || ( x3 > x2*EXT ) )
+                x3 = x2*EXT;
+              else if ( x3 < x2 + INT*(x2 - x1) )
+                x3 = x2 + INT*(x2 - x1);
+            }
+
+          // Interpolate within the bracket [ point 2, point 4 ] until the Wolfe-Powell conditions hold
+          while ( ( ( std::abs(d3) > -SIG*d0 ) || ( f3 > f0 + x3*RHO*d0 ) ) && ( M > 0 ) )
+            {
+              if ( ( d3 > 0 ) || ( f3 > f0 + x3*RHO*d0 ) )
+                {
+                  x4 = x3; f4 = f3; d4 = d3;
+                }
+              else
+                {
+                  x2 = x3; f2 = f3; d2 = d3;
+                }
+              if ( f4 > f0 )
+                x3 = x2 - ( 0.5*d2*(x4 - x2)*(x4 - x2) ) / ( f4 - f2 - d2*(x4 - x2) );
+              else
+                {
+                  double A = 6*(f2 - f4)/(x4 - x2) + 3*(d4 + d2);
+                  double B = 3*(f4 - f2) - (2*d2 + d4)*(x4 - x2);
+                  x3 = x2 + ( std::sqrt(B*B - A*d2*(x4 - x2)*(x4 - x2)) - B ) / A;
+                }
+              if ( !std::isfinite(x3) )
+                x3 = 0.5*(x2 + x4);
+              x3 = std::max(std::min(x3, x4 - INT*(x4 - x2)), x2 + INT*(x4 - x2));
+              f3 = objective(X + x3*s, df3);
+              if ( f3 < F0 )
+                {
+                  X0 = X + x3*s;
+                  F0 = f3;
+                  dF0 = df3;
+                }
+              M -= 1;
+              d3 = df3.dot(s);
+            }
+          accepted = ( std::abs(d3) < -SIG*d0 ) && ( f3 < f0 + x3*RHO*d0 );
+          if ( accepted )
+            {
+              X += x3*s;
+              objective.iteration(X, f3);
+            }
+        }
+
+      if ( accepted )
+        {
+          // Accept the step and compute the Polack-Ribiere direction  [ reverting to steepest descent if it is not a descent direction ]
+          double reduction = f0 - f3;
+          f0 = f3;
+          s = ( ( df3.dot(df3) - df0.dot(df3) ) / df0.dot(df0) )*s - df3;
+          df0 = df3;
+          d3 = d0;
+          d0 = df0.dot(s);
+          if ( d0 > 0 )
+            {
+              s = -df0;
+              d0 = -s.dot(s);
+            }
+          x3 *= std::min(RATIO, d3/(d0 - realmin));
+          lsFailed = false;
+
+          // Stop on a small gradient or relative reduction
+          if ( df0.lpNorm<Eigen::Infinity>() <= options.epsilon )
+            break;
+          if ( ( options.past > 0 ) && ( reduction <= options.delta * std::max(1.0, std::abs(f0)) ) )
+            break;
+        }
+      else
+        {
+          // Restore the best point so far and try steepest descent, unless the previous line search failed as well
+          X = X0;
+          f0 = F0;
+          df0 = dF0;
+          if ( lsFailed )
+            break;
+          s = -df0;
+          d0 = -s.dot(s);
+          x3 = 1.0/(1.0 - d0);
+          lsFailed = true;
+        }
+    }
 
-  // Evaluate covariance kernel on pairwise distance vector
-  Matrix Kv;
-  Kv.noalias() = scaling * ( (-0.5 / std::pow(kernelParams(0),2)) * Dv ).array().exp().matrix();
+  return i;
+}
 
-  // Make sure not to scale the jitter and noise terms
-  squareForm(K, Kv, n, scaling*1.0 + jitter + noise);
 
-  // Compute gradients w.r.t. kernel hyperparameters
-  if ( evalGrad )
+// Minimize an objective with the specified optimizer
+int GP::minimizeObjective(Optimizer optimizer, Objective & objective, Vector & x, double & fx, const Vector & lbs, const Vector & ubs,
+                          const SolverOptions & options)
+{
+  // Translate the stopping criteria for LBFGS++
+  auto lbfgsOptions = [&options](auto & param) {
+                        param.m = options.memory;
+                        param.epsilon = options.epsilon;
+                        param.max_iterations = options.maxIterations;
+                        param.max_linesearch = options.maxLinesearch;
+                        param.past = options.past;
+                        param.delta = options.delta;
+                        if ( options.lineSearchBudget > 0 )
+                          param.max_linesearch = std::min(options.maxLinesearch, options.lineSearchBudget);
+                      };
+
+  switch ( optimizer )
     {
-      // Prepend gradient list with scaling term
-      //int index = 0;
-      //if (!fixedScaling)
-      //  {
-      //    Matrix dK_scaling;
-      //    squareForm(dK_scaling, Kv, n, -noise);
-      //    gradList[index++] = dK_scaling;
-      //  }
-      
-      Matrix dK_i;
-      Matrix dK_iv;
-      dK_iv.noalias() = 1/std::pow(kernelParams(0),2) * ( Dv.array() * Kv.array() ).matrix();
-      squareForm(dK_i, dK_iv, n); // Note: diagVal = 0.0
-      gradList[0] = dK_i.eval();
-      //gradList[index] = dK_i.eval();
+    case Optimizer::LBFGS:
+      {
+        // Trial points of the line search are evaluated without gradients
+        LBFGSpp::LBFGSParam<double> param;
+        lbfgsOptions(param);
+        if ( options.lineSearchBudget > 0 )
+          {
+            LBFGSpp::LBFGSSolver<double, BudgetLineSearch> solver(param);
+            return solver.minimize(objective, x, fx);
+          }
+        LBFGSpp::LBFGSSolver<double, ValueFirstLineSearch> solver(param);
+        return solver.minimize(objective, x, fx);
+      }
+    case Optimizer::LBFGSB:
+      {
+        LBFGSpp::LBFGSBParam<double> param;
+        lbfgsOptions(param);
+        if ( options.lineSearchBudget > 0 )
+          {
+            LBFGSpp::LBFGSBSolver<double, BudgetLineSearch> solver(param);
+            return solver.minimize(objective, x, fx, lbs, ubs);
+          }
+        LBFGSpp::LBFGSBSolver<double, ValueFirstLineSearch> solver(param);
+        return solver.minimize(objective, x, fx, lbs, ubs);
+      }
+    case Optimizer::ConjugateGradient:
+      return conjugateGradient(objective, x, fx, options);
+    case Optimizer::CppOptLib:
+      {
+#ifdef GP_USE_CPPOPTLIB
+        // The solver stops on the projected gradient (1e-4), the relative reduction or the iteration limit
+        CppOptLibProblem problem(objective, lbs, ubs);
+        cppoptlib::LbfgsbSolver<CppOptLibProblem> solver;
+        auto criteria = cppoptlib::Criteria<double>::defaults();
+        criteria.iterations = options.maxIterations;
+        criteria.gradNorm = options.epsilon;
+        criteria.fDelta = ( options.past > 0 ) ? options.delta : 0.0;
+        solver.setStopCriteria(criteria);
+        solver.setHistorySize(options.memory);
+        x = x.cwiseMax(lbs).cwiseMin(ubs);
+        solver.minimize(problem, x);
+        fx = objective.value(x);
+        return static_cast<int>(solver.criteria().iterations);
+#else
+        throw std::invalid_argument("the CppOptLib optimizer requires compiling with GP_USE_CPPOPTLIB");
+#endif
+      }
+    case Optimizer::FisherScoring:
+      break;
     }
-
-};
+  throw std::invalid_argument("Fisher scoring is only available to GaussianProcess::fitModel");
+}
 
 
-// Define distance kernel function for RBF
-// [ Note: Optimize w.r.t. theta = log(l) for stability  ==>   / l^2  instead of  / l^3 ]
-double GP::RBF::evalDistKernel(double d, Vector & params, int n)
+// Find a memoized evaluation  [ components must agree to within a few units of round-off ]
+GP::EvalCache::Entry * GP::EvalCache::find(const Vector & params, int mode)
 {
-  switch (n)
+  for ( auto & entry : entries )
     {
-    case 0: return std::exp( -d / (2.0*std::pow(params(0),2)));
-    case 1: return d / std::pow(params(0),2) * std::exp( -d / (2.0*std::pow(params(0),2)));
-    default: std::cout << "\n[*] UNDEFINED DERIVATIVE\n"; return 0.0;
+      if ( ( entry.mode != mode ) || ( entry.params.size() != params.size() ) || ( params.size() == 0 ) )
+        continue;
+      if ( ( (entry.params - params).array().abs() <= 1e-14 * params.array().abs().max(1.0) ).all() )
+        {
+          entry.stamp = ++clock;
+          return &entry;
+        }
     }
-};
+  return nullptr;
+}
 
 
-// Compute cross covariance between two input vectors using kernel parameters params
-void GP::RBF::computeCrossCov(Matrix & K, Matrix & X1, Matrix & X2, Vector & params)
+// Insert an evaluation in place of the least recently used entry  [ any memoized gradient is invalidated ]
+GP::EvalCache::Entry & GP::EvalCache::insert(const Vector & params, int mode)
 {
-  // Get prediction count
-  auto m = static_cast<int>(X2.rows());
-
-   // Define lambda function to create unary operator (by clamping kernelParams argument)      
-  auto lambda = [=,&params](double d)->double { return evalDistKernel(d, params, 0); };
-  for ( auto j : boost::irange(0,m) )
+  Entry * entry = find(params, mode);
+  if ( !entry )
     {
-      K.col(j) = ((X1.rowwise() - X2.row(j)).rowwise().squaredNorm()).unaryExpr(lambda);          
+      entry = &*std::min_element(entries.begin(), entries.end(), [](const Entry & a, const Entry & b) { return a.stamp < b.stamp; });
+      entry->params = params;
+      entry->mode = mode;
+      entry->stamp = ++clock;
     }
-  
-};
+  entry->hasGrad = false;
+  return *entry;
+}
 
 
-// Evaluate NLML for specified kernel hyperparameters p
-double GP::GaussianProcess::evalNLML(const Vector & p, Vector & g, bool evalGrad)
+// Drop the memoized evaluation of params  [ e.g. when it has to be repeated to rebuild the workspace ]
+void GP::EvalCache::erase(const Vector & params, int mode)
 {
-  time EVAL_start = high_resolution_clock::now();
-  
-  // Get matrix input observation count
-  auto n = static_cast<int>(obsX.rows());
-
-  // ASSUME OPTIMIZATION OVER LOG VALUES
-  auto params = static_cast<Vector>(p);
-  params = params.array().exp().matrix();
-
-  // Compute covariance matrix and store Cholesky factor
-  Matrix K(n,n);
-  time start = high_resolution_clock::now();
-  (*kernel).computeCov(K, obsX, params, gradList, jitter, evalGrad);
-  time end = high_resolution_clock::now();
-  time_computecov += getTime(start, end);
-
-
-  start = high_resolution_clock::now();
-  Eigen::LLT<Matrix> _cholesky(n);
-  _cholesky = K.llt();
-  end = high_resolution_clock::now();
-  time_cholesky_llt += getTime(start, end);
+  if ( auto entry = find(params, mode) )
+    {
+      entry->params.resize(0);
+      entry->hasGrad = false;
+      entry->stamp = 0;
+    }
+}
 
-  start = high_resolution_clock::now();
-  Matrix _alpha = _cholesky.solve(obsY);
-  end = high_resolution_clock::now();
-  time_alpha += getTime(start, end);
-  
-  // Compute NLML value
-  start = high_resolution_clock::now();
-  double NLML_value = (obsY.transpose()*_alpha)(0);
-  NLML_value += n*std::log(2*PI);
-  NLML_value *= 0.5;
-  NLML_value += _cholesky.matrixLLT().diagonal().array().log().sum();
-  end = high_resolution_clock::now();
-  time_NLML += getTime(start, end);
 
-  if ( evalGrad )
+// Drop all memoized evaluations
+void GP::EvalCache::clear()
+{
+  for ( auto & entry : entries )
     {
+      entry.params.resize(0);
+      entry.hasGrad = false;
+      entry.stamp = 0;
+    }
+  hits = 0;
+}
 
-      //
-      // Precompute the multiplicative term in derivative expressions
-      //
-      // [ THIS APPEARS TO BE A COMPUTATIONAL BOTTLE-NECK ]
-      //
 
-      
-      start = high_resolution_clock::now();
-      
-      // Direct Implementation
-      //Matrix term(n,n);
-      //term.noalias() = _cholesky.solve(Matrix::Identity(n,n));
-      //term.noalias() -= _alpha*_alpha.transpose();
+// Allocate workspace buffers [ the gradient term and derivative matrices are only needed for gradient evaluations ]
+// [ In mixed precision mode the double precision buffers are only allocated if an evaluation falls back to double ]
+void GP::Workspace::resize(int n, int augParamCount, int paramCount, bool lowMemory, bool mixedPrecision, bool valueOnly)
+{
+  params.resize(augParamCount);
+  K.resize(mixedPrecision ? 0 : n, mixedPrecision ? 0 : n);
+  Kf.resize(mixedPrecision ? n : 0, mixedPrecision ? n : 0);
+  alpha.resize(n,1);
+  residual.resize(n,1);
+  correction.resize(mixedPrecision ? n : 0);
+  term.resize(0,0);
+  termF.resize(0,0);
+  if ( !lowMemory && !valueOnly )
+    {
+      if ( mixedPrecision )
+        termF.resize(n,n);
+      else
+        term.resize(n,n);
+    }
+  inverse.resize(0,0);
+  derivs.clear();
+  products.clear();
+  dKalpha.resize(0,0);
+  weighted.resize(0,0);
+  traces.resize(paramCount);
+  traceVals.reserve( static_cast<std::size_t>((n + 15)/16) * ( (paramCount + 7)/8 ) * 8 );
+}
 
-      // Using Solve In Place
-      //Matrix term = Matrix::Identity(n,n);
-      //_cholesky.solveInPlace(term);
-      //term.noalias() -= _alpha*_alpha.transpose();
 
-      
-      //
-      //  MULTI-THREADED IMPLEMENTATION
-      //
-      Matrix term = Matrix::Identity(n,n);
+// Rebuild the cached squared distance matrix when the observations have changed
+void GP::GaussianProcess::updateDistances()
+{
+  if ( !distStale || sharedDist )
+    return;
+  
+  sqDist(obsDist, obsX, obsX);
+  distStale = false;
+}
 
-      // Get thread count
-      int threadCount = Eigen::nbThreads( );
-      
-      // Get problem dimension d per thread
-      auto d = static_cast<int>(n/threadCount);
 
-      // Construct partitioned list of block terms for solver
-      std::vector<Matrix> termList;      
-      for ( auto i : boost::irange(0,threadCount-1) )
-        termList.emplace_back(term.block(0,i*d,n,d));
+// Define simplified interface for evaluating NLML without gradient calculation
+double GP::GaussianProcess::evalNLML(const Vector & p)
+{
+  Vector nullGrad(0);
+  return evalNLML(p,nullGrad,false);
+}
 
-      // Ensure the final block extends to column n (i.e. account for index roundoff)
-      termList.emplace_back(term.block(0, (threadCount-1)*d, n, n - (threadCount-1)*d) );
 
-      // Define lambda function specifying each threads solver task
-      auto lambda = [&termList,&_cholesky](int i) { _cholesky.solveInPlace(termList[i]); };
+// Recompute the spectrum of the unscaled kernel matrix when the observations or kernel parameters have changed
+//  [ K0 = Q diag(lambda) Q^T  is computed once, after which only  lambda  and  Q^T y  are retained ]
+void GP::GaussianProcess::updateSpectrum()
+{
+  Vector params = (*kernel).getParams();
+  if ( !spectrumStale && ( spectrumParams.size() == params.size() ) && ( spectrumParams == params ) )
+    return;
 
-      // Initialize thread list
-      std::vector<std::thread> threadList;
+  Matrix Q;
+  (*kernel).computeCrossCov(Q, obsX, obsX, params);
+  symmetricEigen(Q, eigenvalues);
 
-      // Assign tasks to threads
-      for ( auto i : boost::irange(0,threadCount) )
-        threadList.emplace_back(lambda,i);
+  // Clamp round-off in the null space of K0, which is positive semi-definite
+  eigenvalues = eigenvalues.cwiseMax(0.0);
+  projectedY.noalias() = Q.transpose() * obsY.col(0);
 
-      // Join threads
-      for ( auto & thread : threadList )
-        thread.join();
+  spectrumParams = params;
+  spectrumStale = false;
+}
 
-      // Reassemble blocks from solver threads back into original matrix
-      for ( auto i : boost::irange(0,threadCount-1) )
-        term.block(0,i*d,n,d) = termList[i];
-      term.block(0, (threadCount-1)*d, n, n - (threadCount-1)*d) = termList[threadCount-1];
-      
-      // Compute final multiplicative term:  K^-1 - alpha*alpha^T
-      term.noalias() -= _alpha*_alpha.transpose();
 
-      
-      end = high_resolution_clock::now();
-      time_term += getTime(start, end);
+// Evaluate NLML and its derivatives with respect to the noise and scaling levels in O(n) from the cached spectrum
+//
+//   K = scaling*K0 + (noise + jitter)*I = Q diag(d) Q^T,   d_i = scaling*lambda_i + noise + jitter,   z = Q^T y
+//
+//   NLML            =  1/2 sum_i [ z_i^2/d_i + log(d_i) ]  +  n/2 log(2 pi)
+//   dNLML/dnoise    =  1/2 sum_i [ 1/d_i - z_i^2/d_i^2 ]
+//   dNLML/dscaling  =  1/2 sum_i [ 1/d_i - z_i^2/d_i^2 ] lambda_i
+double GP::GaussianProcess::spectralNLML(double noise, double scaling, double * gNoise, double * gScaling)
+{
+  auto n = static_cast<int>(eigenvalues.size());
+  auto d = (scaling*eigenvalues.array() + (noise + jitter));
+  if ( !( d.minCoeff() > 0.0 ) )
+    {
+      if ( gNoise )  *gNoise = 0.0;
+      if ( gScaling )  *gScaling = 0.0;
+      return std::numeric_limits<double>::infinity();
+    }
 
+  auto z2 = projectedY.array().square();
+  double value = 0.5*( (z2/d).sum() + d.log().sum() ) + 0.5*n*std::log(2.0*PI);
+  if ( gNoise )
+    *gNoise = 0.5*( d.inverse() - z2/d.square() ).sum();
+  if ( gScaling )
+    *gScaling = 0.5*( ( d.inverse() - z2/d.square() ) * eigenvalues.array() ).sum();
+  return value;
+}
 
-      start = high_resolution_clock::now();      
-      // Compute gradient for noise term if 'fixedNoise=false'
-      int index = 0;
-      double noise;
-      if (!fixedNoise)
-        {
-          // Specify gradient of white noise kernel  [ dK_i = params(0)*Matrix::Identity(n,n) ]
-          //g(index++) = 0.5 * (term * params(0)).trace() ;
-          noise = params(0);
-          g(index) = term.trace();
-          g(index++) *= 0.5 * noise;
-          //g(index++) *= 0.5 * params(0);
-        }
-      else
-        noise = noiseLevel;
 
-      
-      if (!fixedScaling)
-        {
-          if (!fixedNoise)
-            {
-              double trace = 0.0;
-              for ( auto j : boost::irange(0, n) )
-                trace -= _alpha(j)*obsY(j);
-              trace += n;
-              trace *= 0.5;
-              // Add  1/2 * trace[(noise * term)]  (i.e. the noise gradient)
-              trace -= g(index-1);
-              g(index++) = trace;
-            }
-          else
-            {
-              double trace = 0.0;
-              Matrix dK = K - noise*Matrix::Identity(n,n);
-              for ( auto j : boost::irange(0, n) )
-                trace += term.row(j)*dK.col(j);
-              g(index++) = 0.5*trace;
-            }
-          //  
-          //  NOTE: The following implementation does not account for noise term (!)
-          //
-          //  Ah, it's so close though...
-          //
-          //  The adjusted covariance matrix is:  K'  =  s * K  +  noise * I  
-          //
-          //  But if we had   K' = s*K   and set   t = log(s) ~ s = exp(t) :
-          //
-          //  ( so that  dK'/dt  =  d/dt[ s*K ]  =  d/ds[ s*K ] * ds/dt  =  s * K  =  K'  )
-          //
-          //  then it would give us the reduction:
-          //
-          //  d/dt -log p(y|X,t)  =  -1/2 * trace[ ( (K'^-1 y)(K'^-1 y)^T - K'^-1 ) dK'/dt  ]
-          //
-          //   =  -1/2 * trace[ ( K'^-1 y y^T K'^-1 - K'^-1 ) dK'/dt  ]
-          //
-          //   =  -1/2 * trace[ ( K'^-1 y y^T K'^1 - K'^-1 ) K'  ]
-          //
-          //   =  -1/2 * trace[  (K'^-1 y) y^T - I  ]
-          //
-          //   =  -1/2 * trace[  alpha * y^T - I  ]
-          //
-          //
-          //  but...    we do have:
-          //  
-          //   dK'/dt  =  d/dt[s*K]  =  s * K  =  K' - noise * I
-          //
-          //  so that the (corected) calculation above still yields:
-          //
-          //   =  -1/2 * trace[  (alpha * y^T - I)  -  noise * term  ]
-          //
-          //  and the trace of "term" has already been calculated...
-          //
-          //
-          //double trace = 0.0;
-          //for ( auto i : boost::irange(0,n) )
-          //  trace -= _alpha(i)*obsY(i);
-          //trace += n;
-          //g(index++) = 0.5 * trace;
-        }
+// Evaluate NLML for log noise/scaling levels p when the kernel parameters are fixed  [ fixed levels are omitted from p ]
+double GP::GaussianProcess::evalSpectralNLML(const Vector & p, Vector & g, bool evalGrad)
+{
+  updateSpectrum();
 
-      // Specify gradient w.r.t. the kernel scaling parameter
-      //if (!fixedScaling)
-      //  gradList.insert(gradList.begin(), K - noise*Matrix::Identity(n,n));
-      
-      // Compute gradients with respect to kernel hyperparameters
-      for (auto dK_i = gradList.begin(); dK_i != gradList.end(); ++dK_i) 
-        {
-          // Compute trace of full matrix
-          //g(index++) = 0.5 * (term * (*dK_i) ).trace() ;
-
-          // POSSIBLE MULTI-THREADED IMPLEMENTATION
-          // Construct zero initialized vector of partial trace values
-          Matrix traceVals = Eigen::MatrixXd::Zero(threadCount,1);
-
-          std::vector<int> startVals;
-          for ( auto i : boost::irange(0,threadCount) )
-            startVals.emplace_back(i*d);
-
-          std::vector<int> endVals;
-          for ( auto i : boost::irange(1,threadCount) )
-            endVals.emplace_back(i*d);
-          endVals.emplace_back(n);
-
-          // Define lambda function specifying each threads solver task
-          auto lambda = [&term,&dK_i,&traceVals](int i, int startInd, int endInd) {
-                          for ( auto j : boost::irange(startInd, endInd) )
-                            traceVals(i) += term.row(j)*(*dK_i).col(j);
-                        };
-
-          // Initialize thread list
-          std::vector<std::thread> traceThreadList;
-
-          // Assign tasks to threads
-          for ( auto i : boost::irange(0,threadCount) )
-            traceThreadList.emplace_back(lambda,i,startVals[i],endVals[i]);
-
-          // Join threads
-          for ( auto & thread : traceThreadList )
-            thread.join();
-
-          // Compute final trace value for derivative calculation
-          g(index++) = 0.5*(traceVals.sum());
-          
-        }
-      end = high_resolution_clock::now();
-      time_grad += getTime(start, end);
+  int index = 0;
+  double noise = fixedNoise ? noiseLevel : std::exp(p(index++));
+  double scaling = fixedScaling ? scalingLevel : std::exp(p(index++));
 
-      // Update gradient evaluation count
+  functionEvals += 1;
+  double gNoise, gScaling;
+  double value = spectralNLML(noise, scaling, evalGrad ? &gNoise : nullptr, evalGrad ? &gScaling : nullptr);
+  if ( evalGrad )
+    {
+      // Convert to derivatives with respect to the log levels
+      index = 0;
+      if ( !fixedNoise )
+        g(index++) = noise*gNoise;
+      if ( !fixedScaling )
+        g(index++) = scaling*gScaling;
       gradientEvals += 1;
-
     }
-  
-  time EVAL_end = high_resolution_clock::now();
-  time_evaluation += getTime(EVAL_start, EVAL_end);
-  return NLML_value;
-  
-}
-
-
-// Define simplified interface for evaluating NLML without gradient calculation
-double GP::GaussianProcess::evalNLML(const Vector & p)
-{
-  Vector nullGrad(0);
-  return evalNLML(p,nullGrad,false);
+  return value;
 }
 
 
@@ -485,129 +2615,474 @@ int GP::GaussianProcess::getAugParamCount(int count)
 // Fit model hyperparameters
 void GP::GaussianProcess::fitModel()
 {
+  // Fit the hyperparameters on subsets of the observations first  [ before the thread budget of this fit is applied,
+  //   so that the stage fits are not counted as concurrently running models ]
+  bool subsampled = fitSubsamples();
+
+  // Apply the model thread budget
+  ThreadScope threads(threadConfig);
 
   // Get combined parameter/noise vector size
   paramCount = (*kernel).getParamCount();
   //augParamCount = (fixedNoise) ? static_cast<int>(paramCount) : static_cast<int>(paramCount) + 1 ;
   augParamCount = getAugParamCount(paramCount);
 
+  // Only the noise and scaling levels are optimized when the kernel parameters are held fixed,
+  // and the scaling level is removed from the optimization when it is profiled  [ not by Fisher scoring, which is only used
+  // when the dense gradient term is available ]
+  bool scoring = ( optimizer == Optimizer::FisherScoring ) && !lowMemory && !mixedPrecision && !fixedParams;
+  profiling = profiledScaling && !fixedNoise && !fixedScaling && !fixedParams && !scoring;
+  int freeCount = fixedParams ? getAugParamCount(0) : augParamCount - ( profiling ? 1 : 0 );
+
+  // Memoized evaluations from a previous fit may use a different parameter layout
+  evalCache.clear();
+
   // Pass noise level to kernel when 'fixedNoise=true'
   if ( fixedNoise )
     (*kernel).setNoise(noiseLevel);
   if ( fixedScaling )
     (*kernel).setScaling(scalingLevel);
 
-  // Declare vector for storing gradient calculations
-  Vector g(augParamCount);
-
-  // Initialize gradient list with identity matrices
-  //for ( auto i : boost::irange(0,augParamCount) )
-  //int gradientCount = paramCount;
-  //if (!fixedScaling)
-  //  gradientCount += 1;
-  //for ( auto i : boost::irange(0,gradientCount) )
-
-  for ( auto i : boost::irange(0,paramCount) )
+  // Release buffers which are not used in low-memory mode
+  if ( lowMemory )
     {
-      // Avoid compiler warning for unused variable
-      (void)i;
-      gradList.push_back(Matrix::Identity(static_cast<int>(obsY.size()),static_cast<int>(obsY.size())));
+      obsDist.resize(0,0);
+      distStale = true;
+      cholFactor.resize(0,0);
     }
 
+  // Size evaluation workspace once for all optimizer iterations  [ or factor the kernel matrix once when the kernel parameters are fixed ]
+  if ( fixedParams )
+    updateSpectrum();
+  else
+    workspace.resize(static_cast<int>(obsX.rows()), augParamCount, paramCount, lowMemory, mixedPrecision);
+
+  // Build the observation distance matrix once for all optimizer iterations and restarts
+  if ( !lowMemory )
+    updateDistances();
 
-  // Convert hyperparameter bounds to log-scale
-  Vector lbs, ubs;
+  // Convert hyperparameter bounds to log-scale  [ restart points are sampled from (0.01, 2.0) by default, while the
+  //   bounded solver only confines the hyperparameters to (1e-5, 1e5) unless bounds are specified ]
+  Vector lbs, ubs, solverLbs, solverUbs;
   parseBounds(lbs, ubs, augParamCount);
+  parseBounds(solverLbs, solverUbs, augParamCount, 1e-5, 1e5);
+  //  [ the profiled first coordinate is log(noise/scaling), whose bounds follow from those of the noise and scaling levels ]
+  if ( profiling )
+    {
+      for ( auto bounds : { std::make_pair(&lbs, &ubs), std::make_pair(&solverLbs, &solverUbs) } )
+        {
+          Vector lower = *bounds.first;
+          Vector upper = *bounds.second;
+          bounds.first->resize(freeCount);
+          bounds.second->resize(freeCount);
+          *bounds.first << lower(0) - upper(1), lower.tail(paramCount);
+          *bounds.second << upper(0) - lower(1), upper.tail(paramCount);
+        }
+    }
+  for ( Vector * bounds : { &lbs, &ubs, &solverLbs, &solverUbs } )
+    bounds->conservativeResize(freeCount);
+
+  // Set initial guess from the previous fit (warm start), the user-specified hyperparameters or zero log-hyperparameters
+  //  [ stored in the augmented layout; when profiled, the noise level is taken relative to the scaling level, which is
+  //    dropped, and the kernel parameters are dropped when fixed ]
+  bool warm = ( warmStart || subsampled ) && ( fittedParams.size() == augParamCount );
+  Vector initial = Eigen::MatrixXd::Zero(augParamCount,1);
+  if ( warm )
+    initial = fittedParams;
+  else if ( initialParams.size() == augParamCount )
+    initial = initialParams.array().log().matrix();
+  if ( profiling )
+    {
+      Vector full = initial;
+      initial.resize(freeCount);
+      initial << full(0) - full(1), full.tail(paramCount);
+    }
+  initial.conservativeResize(freeCount);
 
   // Initialize optimal hyperparamter values
-  Vector optParams = Eigen::MatrixXd::Zero(augParamCount,1);
-
-  // Define restart count for optimizer
-  int restartCount = solverRestarts;
+  Vector optParams = initial;
 
   // Declare variables to store optimization loop results
   double currentVal;
   double optVal = 1e9;
-  Vector theta(augParamCount);
+  Vector theta(freeCount);
+
+  // Define low-precision solver options for restart loop
+  SolverOptions restartOptions;
+  restartOptions.memory = 10;
+  restartOptions.epsilon = 1e-6;
+  restartOptions.maxIterations = 10;
+  restartOptions.maxLinesearch = 5;
+  restartOptions.past = 0;
+  restartOptions.delta = 1e-4;
+  restartOptions.lineSearchBudget = lineSearchBudget;
 
-  // Define low-precision solver for restart loop
-  LBFGSpp::LBFGSParam<double> param;
-  param.linesearch  = LBFGSpp::LBFGS_LINESEARCH_BACKTRACKING_STRONG_WOLFE;
-  param.m = 10;
-  param.epsilon = 1e-6;
-  param.max_iterations = 10;
-  param.max_linesearch = 5;
-  param.delta = 1e-4;
+  // Line Search Options
+  //param.linesearch  = LBFGSpp::LBFGS_LINESEARCH_BACKTRACKING_ARMIJO;
+  //param.linesearch  = LBFGSpp::LBFGS_LINESEARCH_BACKTRACKING_WOLFE;
+  //param.linesearch  = LBFGSpp::LBFGS_LINESEARCH_BACKTRACKING_STRONG_WOLFE;
 
-  int niter;
-  
-  // Evaluate optimizer with various different initializations
-  for ( auto i : boost::irange(0,restartCount) )
+  // TRY MODELLING SCIPY fmin_l_bfgs_b PARAMETERS
+  double eps = 2.220446049250313e-16;
+  double factr = solverPrecision;
+  SolverOptions finalOptions;
+  finalOptions.memory = 10;
+  finalOptions.epsilon = 1e-5;
+  finalOptions.maxLinesearch = 20;
+  finalOptions.past = 1;
+  //finalOptions.ftol = factr*eps;
+  finalOptions.delta = factr*eps;
+  finalOptions.maxIterations = 100;
+  finalOptions.lineSearchBudget = lineSearchBudget;
+
+  // Only a few iterations are run on the full observations after fitting the subsets
+  if ( subsampled )
+    finalOptions.maxIterations = subsampleIterations;
+
+  int niter = 0;
+
+  // Run the selected optimizer  [ Fisher scoring falls back to L-BFGS-B without the dense gradient term, as do optimizers which
+  //   were not compiled in ]
+  Optimizer method = optimizerAvailable(optimizer) ? optimizer : Optimizer::LBFGSB;
+  if ( ( method == Optimizer::FisherScoring ) && !scoring )
+    method = Optimizer::LBFGSB;
+  auto solve = [&](GaussianProcess & model, bool final, Vector & theta, double & value) {
+                 if ( method == Optimizer::FisherScoring )
+                   return model.minimizeFisher(theta, value, solverLbs, solverUbs, final ? finalOptions : restartOptions);
+                 return minimizeObjective(method, model, theta, value, solverLbs, solverUbs, final ? finalOptions : restartOptions);
+               };
+
+  // Run a solver, continuing in double precision if the line search fails on the mixed precision objective
+  //  [ the single precision log-determinant can be too noisy for strong Wolfe conditions near the optimum;
+  //    the solver leaves theta at the last point evaluated by the line search ]
+  auto minimize = [&solve](GaussianProcess & model, bool final, Vector & theta, double & value) {
+                    if ( model.mixedPrecision )
+                      {
+                        try { return solve(model, final, theta, value); }
+                        catch ( const std::runtime_error & ) { }
+                      }
+                    bool mixed = model.mixedPrecision;
+                    model.mixedPrecision = false;
+                    try
+                      {
+                        int iterations = solve(model, final, theta, value);
+                        model.mixedPrecision = mixed;
+                        return iterations;
+                      }
+                    catch ( ... )
+                      {
+                        model.mixedPrecision = mixed;
+                        throw;
+                      }
+                  };
+
+  // A warm-started refit first continues from the previous hyperparameters, and only falls back on the random restarts
+  //   and the final solve if its NLML per observation is worse than that of the previous fit by more than the tolerance
+  //   [ a fit continuing from the subsets never falls back ]
+  auto n = static_cast<int>(obsX.rows());
+  bool warmConverged = false;
+  if ( warm && ( freeCount > 0 ) )
     {
-      if ( i == 0 )
+      theta = optParams;
+      currentVal = value(theta);
+      try { niter = minimize(*this, true, optParams, optVal); }
+      catch ( const std::runtime_error & ) { }
+      if ( !( optVal <= currentVal ) )
         {
-          // Set initial guess (should make this user specifiable...)
-          theta = Eigen::MatrixXd::Zero(augParamCount,1);
+          optParams = theta;
+          optVal = currentVal;
         }
+      warmConverged = subsampled || ( optVal/n <= fittedNLML + warmTolerance * std::max(1.0, std::abs(fittedNLML)) );
+    }
+
+  // Define restart count for optimizer  [ the first restart of a warm-started refit is the continued previous fit ]
+  int restartCount = ( ( freeCount > 0 ) && !warmConverged ) ? solverRestarts : 0;
+  int firstRestart = warm ? 1 : 0;
+
+  // Run tasks concurrently, each thread evaluating on its own model which shares the distance matrix of this model
+  //  [ the thread budget is divided between the running tasks; low-memory and fixed-parameter fits run their tasks
+  //    sequentially on this model ]
+  int budget = ThreadScope::resolve(threadConfig).totalThreads;
+  std::vector<std::unique_ptr<GaussianProcess>> models;
+
+  // Cap the number of concurrent models by the memory budget  [ each model holds an n x n covariance / factor and, unless
+  //   it only evaluates values, a gradient term, plus K^-1 and the derivative products of the kernel hyperparameters for
+  //   Fisher scoring; the workspace of this model counts towards the budget ]
+  double squares = static_cast<double>(obsX.rows()) * static_cast<double>(obsX.rows());
+  double valueBytes = squares * ( mixedPrecision ? sizeof(float) : sizeof(double) );
+  double modelBytes = 2*valueBytes;
+  if ( method == Optimizer::FisherScoring )
+    modelBytes += squares * sizeof(double) * ( 1 + 2*paramCount );
+  double memory = ( taskMemory > 0 ) ? taskMemory : 0.5*physicalMemory();
+  auto memoryCap = [&](bool valueOnly) {
+                     return ( memory > 0 ) ? static_cast<int>( std::min((memory - modelBytes)/( valueOnly ? valueBytes : modelBytes ), 1e6) ) : budget;
+                   };
+
+  auto runTasks = [&](int count, bool valueOnly, const std::function<void(GaussianProcess &, int, int)> & task) {
+                    int concurrent = ( lowMemory || fixedParams ) ? 1 : std::max(1, std::min({count, budget, memoryCap(valueOnly)}));
+                    while ( ( concurrent > 1 ) && ( static_cast<int>(models.size()) < concurrent ) )
+                      {
+                        models.emplace_back(new GaussianProcess());
+                        models.back()->shareModel(*this);
+                      }
+                    // Release the workspaces of models left idle by this batch  [ e.g. screening models beyond the restart concurrency ]
+                    for ( auto k : boost::irange(std::min(concurrent, static_cast<int>(models.size())), static_cast<int>(models.size())) )
+                      models[k]->workspace = Workspace();
+                    std::atomic<int> next{0};
+                    std::exception_ptr error = nullptr;
+                    std::mutex errorMutex;
+                    auto work = [&](int k) {
+                                  GaussianProcess & model = models.empty() ? *this : *models[k];
+                                  for ( int i = next++; i < count; i = next++ )
+                                    task(model, k, i);
+                                };
+                    if ( concurrent == 1 )
+                      {
+                        work(0);
+                        return;
+                      }
+                    // The workers run on dedicated threads rather than the thread pool  [ a thread waiting in a nested pool loop runs
+                    //   any queued task, so a pooled worker could run the remaining restarts nested on the stack of a suspended one ].
+                    //   Exceptions escaping a worker are rethrown on the caller once all workers have joined
+                    //   [ as in the sequential case; the remaining tasks are abandoned ]
+                    std::vector<std::thread> threads;
+                    for ( auto k : boost::irange(0,concurrent) )
+                      threads.emplace_back([&, k]() {
+                                             ThreadConfig config = threadConfig;
+                                             config.totalThreads = std::max(1, budget/concurrent);
+                                             config.blasThreads = std::min(config.blasThreads, config.totalThreads);
+                                             config.taskThreads = std::min(config.taskThreads, config.totalThreads);
+                                             ThreadScope scope(config);
+                                             try
+                                               {
+                                                 work(k);
+                                               }
+                                             catch (...)
+                                               {
+                                                 std::lock_guard<std::mutex> lock(errorMutex);
+                                                 if ( !error )
+                                                   error = std::current_exception();
+                                                 next = count;
+                                               }
+                                           });
+                    for ( auto & thread : threads )
+                      thread.join();
+                    if ( error )
+                      std::rethrow_exception(error);
+                  };
+
+  // Screen a quasi-random design of initial guesses with value-only evaluations  [ the first design point is the initial
+  //   guess; the best points seed the restarts in order, or the final solve when there are no restarts ]
+  std::vector<Vector> starts(restartCount);
+  int screenCount = ( ( freeCount > 0 ) && !warmConverged ) ? initParamSearchCount : 0;
+  Matrix design = sampleHalton(std::max(screenCount-1, 0), lbs, ubs);
+  std::vector<double> designValues(screenCount);
+  std::vector<int> ranking(screenCount);
+  runTasks(screenCount, true, [&](GaussianProcess & model, int, int i) {
+                          // Screening models hold no gradient term until they run a restart
+                          Vector point = ( i == 0 ) ? initial : static_cast<Vector>(design.row(i-1).transpose());
+                          auto paramSize = static_cast<int>(point.size()) + ( model.profiling ? 1 : 0 );
+                          if ( model.workspace.alpha.rows() != obsX.rows() )
+                            model.workspace.resize(static_cast<int>(obsX.rows()), paramSize, paramCount, lowMemory, mixedPrecision, true);
+                          double value = model.value(point);
+                          designValues[i] = std::isnan(value) ? std::numeric_limits<double>::infinity() : value;
+                        });
+  for ( auto i : boost::irange(0,screenCount) )
+    ranking[i] = i;
+  std::stable_sort(ranking.begin(), ranking.end(), [&designValues](int a, int b) { return designValues[a] < designValues[b]; });
+  auto designPoint = [&](int rank) { return ( ranking[rank] == 0 ) ? initial : static_cast<Vector>(design.row(ranking[rank]-1).transpose()); };
+  if ( ( screenCount > 0 ) && ( restartCount == 0 ) && ( designValues[ranking[0]] < optVal ) )
+    {
+      optParams = designPoint(0);
+      optVal = designValues[ranking[0]];
+    }
+
+  // Set the initial guess of each restart  [ restart i draws from its own random stream when it is not seeded by the screening,
+  //   so that results only depend on scheduling through early abandonment ]
+  auto seed = ( restartCount > 1 ) ? static_cast<unsigned>(std::rand()) : 0u;
+  for ( auto i : boost::irange(std::min(firstRestart,restartCount),restartCount) )
+    {
+      int rank = i - firstRestart;
+      if ( ( rank < screenCount ) && std::isfinite(designValues[ranking[rank]]) )
+        starts[i] = designPoint(rank);
+      else if ( i == 0 )
+        starts[i] = initial;
       else
         {
           // Sample initial hyperparameter vector
-          theta = sampleUnifVector(lbs, ubs);
+          std::seed_seq sequence{seed, static_cast<unsigned>(i)};
+          std::mt19937 generator(sequence);
+          starts[i] = sampleUnifVector(lbs, ubs, generator);
         }
+    }
 
-      // Create solver and function object
-      LBFGSpp::LBFGSSolver<double> solver(param);
-      niter = solver.minimize(*this, theta, currentVal);
-      
-      // Compute current NLML and store parameters if optimal
-      if ( currentVal < optVal ) { optVal = currentVal; optParams = theta; }
-      
+  // Run the restarts concurrently
+  std::vector<Vector> restartParams(restartCount);
+  std::vector<double> restartValues(restartCount, std::numeric_limits<double>::infinity());
+  std::vector<int> restartModels(restartCount, -1);
+  RestartBoard board;
+  board.best.assign(restartCount, std::numeric_limits<double>::infinity());
+  if ( warm && ( restartCount > 0 ) )
+    board.best[0] = optVal;
+  runTasks(restartCount - std::min(firstRestart, restartCount), false, [&](GaussianProcess & model, int k, int task) {
+                                                                   // Create solver and function object  [ restarts whose line search fails are discarded,
+                                                                   //   e.g. when a long first step lands on the flat region of vanishing lengthscales;
+                                                                   //   abandoned restarts hand over their best accepted iterate ]
+                                                                   int i = task + firstRestart;
+                                                                   Vector start = starts[i];
+                                                                   double value;
+                                                                   model.restartBoard = &board;
+                                                                   model.restartIndex = i;
+                                                                   model.restartIterations = 0;
+                                                                   try { minimize(model, false, start, value); }
+                                                                   catch ( const std::runtime_error & ) { model.restartBoard = nullptr; return; }
+                                                                   catch ( const AbandonRestart & )
+                                                                     {
+                                                                       model.restartBoard = nullptr;
+                                                                       restartParams[i] = model.restartBestParams;
+                                                                       restartValues[i] = model.restartBestValue;
+                                                                       restartModels[i] = k;
+                                                                       return;
+                                                                     }
+                                                                   model.restartBoard = nullptr;
+                                                                   restartParams[i] = start;
+                                                                   restartValues[i] = value;
+                                                                   restartModels[i] = k;
+                                                                 });
+
+  // Store parameters of the best restart [ ties go to the earlier restart ]
+  for ( auto i : boost::irange(0,restartCount) )
+    if ( restartValues[i] < optVal ) { optVal = restartValues[i]; optParams = restartParams[i]; }
+
+  // Collect evaluation counts and hand the best restart's memoized value and gradient to the final solve
+  for ( auto & model : models )
+    {
+      functionEvals += model->functionEvals;
+      gradientEvals += model->gradientEvals;
+      fisherEvals += model->fisherEvals;
+      mixedFallbacks += model->mixedFallbacks;
+      jitterEscalations += model->jitterEscalations;
+      evalCache.hits += model->evalCache.hits;
+    }
+  auto best = std::min_element(restartValues.begin(), restartValues.end()) - restartValues.begin();
+  if ( !models.empty() && ( restartCount > 0 ) && ( restartModels[best] >= 0 ) )
+    {
+      if ( auto entry = models[restartModels[best]]->evalCache.find(optParams, evalMode()) )
+        {
+          auto & copy = evalCache.insert(optParams, evalMode());
+          copy.value = entry->value;
+          copy.scale = entry->scale;
+          copy.grad = entry->grad;
+          copy.hasGrad = entry->hasGrad;
+        }
     }
+  models.clear();
 
   // Perform one last optimization starting from best parameters so far
   //if ( restartCount == 0 ) 
   //  optParams = sampleUnifVector(lbs, ubs);
     
 
-  LBFGSpp::LBFGSParam<double> finalparam;
-
-  // Line Search Options
-  //param.linesearch  = LBFGSpp::LBFGS_LINESEARCH_BACKTRACKING_ARMIJO;
-  //param.linesearch  = LBFGSpp::LBFGS_LINESEARCH_BACKTRACKING_WOLFE;
-  //param.linesearch  = LBFGSpp::LBFGS_LINESEARCH_BACKTRACKING_STRONG_WOLFE;
-
-  // TRY MODELLING SCIPY fmin_l_bfgs_b PARAMETERS
-  finalparam.m = 10;
-  finalparam.epsilon = 1e-5;
-  finalparam.max_linesearch = 20;
-  double eps = 2.220446049250313e-16;
-  double factr = solverPrecision;
-  finalparam.past = 1;
-  //finalparam.ftol = factr*eps;
-  finalparam.delta = factr*eps;
-  finalparam.max_iterations = 100;
-  
-  // Create solver and function object
-  LBFGSpp::LBFGSSolver<double> finalsolver(finalparam);
-  niter = finalsolver.minimize(*this, optParams, optVal);
+  // Run the final solve  [ a line search which fails near the optimum, where NLML differences fall below
+  //   round-off, ends the final solve; the starting point is kept if the last trial point is worse ]
+  if ( ( freeCount > 0 ) && !warmConverged )
+    {
+      theta = optParams;
+      currentVal = optVal;
+      try { niter = minimize(*this, true, optParams, optVal); }
+      catch ( const std::runtime_error & )
+        {
+          if ( !( optVal <= currentVal ) )
+            {
+              optParams = theta;
+              optVal = currentVal;
+            }
+        }
+    }
 
   if ( VERBOSE )
     {
+      std::cout << "\n[*] Optimizer = " << optimizerName(method) <<std::endl;
       std::cout << "\n[*] Solver Iterations = " << niter <<std::endl;
-      std::cout << "\n[*] Function Evaluations = " << gradientEvals <<std::endl;
+      if ( warm )
+        std::cout << "\n[*] Warm Start = " << ( warmConverged ? "converged" : "fell back on restarts" ) <<std::endl;
+      std::cout << "\n[*] Cached Evaluations = " << evalCache.hits <<std::endl;
+      std::cout << "\n[*] Function Evaluations = " << functionEvals <<std::endl;
+      std::cout << "\n[*] Gradient Evaluations = " << gradientEvals <<std::endl;
+      if ( method == Optimizer::FisherScoring )
+        std::cout << "\n[*] Fisher Information Evaluations = " << fisherEvals <<std::endl;
+      if ( mixedPrecision )
+        std::cout << "\n[*] Double Precision Fallbacks = " << mixedFallbacks <<std::endl;
+      std::cout << "\n[*] Jitter Escalations = " << jitterEscalations <<std::endl;
     }
   
+  // Recover the optimal scaling level and express the noise level in absolute terms
+  if ( profiling )
+    {
+      evalNLML(optParams);
+      Vector logParams(augParamCount);
+      logParams << optParams(0) + std::log(profiledScale), std::log(profiledScale), optParams.tail(paramCount);
+      optParams = logParams;
+      profiling = false;
+    }
+
+  // The optimizer's final iterate is normally the last point evaluated, in which case its factorization is still held by the workspace
+  bool reuseFactor = workspace.cacheValid && !workspace.cachedMixed && !profiling && !fixedParams
+                     && ( workspace.cachedParams.size() == optParams.size() ) && ( workspace.cachedParams == optParams );
+
   // ASSUME OPTIMIZATION OVER LOG VALUES
   optParams = optParams.array().exp().matrix();
 
+  // Append the fixed kernel parameters
+  if ( fixedParams )
+    {
+      optParams.conservativeResize(augParamCount);
+      optParams.tail(paramCount) = (*kernel).getParams();
+    }
+
   ///* [ This is included in the SciKit Learn model.fit() call as well ]
 
-  // Recompute covariance and Cholesky factor
-  auto n = static_cast<int>(obsX.rows());
-  Matrix K(n,n);
-  (*kernel).computeCov(K, obsX, optParams, gradList, jitter, false);
-  cholesky = K.llt();
-  alpha.noalias() = cholesky.solve(obsY);
+  // Recompute covariance and Cholesky factor in double precision [ in low-memory mode the workspace buffer is handed over to the factor ]
+  workspace.Kf.resize(0,0);
+  workspace.termF.resize(0,0);
+  if ( reuseFactor )
+    {
+      cholFactor.swap(workspace.K);
+      alpha = workspace.alpha;
+      workspace.cacheValid = false;
+    }
+  else
+    {
+      if ( lowMemory )
+        {
+          (*kernel).computeCovLower(workspace.K, distances(), optParams, jitter);
+          cholFactor.swap(workspace.K);
+          workspace.K.resize(0,0);
+        }
+      else
+        (*kernel).computeCov(cholFactor, obsDist, optParams, jitter);
+      factorInfo = robustCholesky(cholFactor, jitter, maxJitterAttempts, lowMemory, DEFAULT_BACKEND, tileSize, &workspace.factorGraph,
+                                  &workspace.savedDiagonal);
+      alpha = obsY;
+      choleskySolve(cholFactor, alpha);
+    }
+  if ( !factorInfo.success )
+    std::cout << "\n [*] WARNING: covariance matrix is not positive definite after " << factorInfo.attempts << " jitter escalations\n";
+  else if ( VERBOSE )
+    std::cout << "\n[*] Final Jitter = " << getJitter() << "  (rcond estimate " << factorInfo.rcond << ")" <<std::endl;
+
+  // Memoize the NLML of the fitted model for post-fit queries, and keep the fitted log-hyperparameters for warm starts
+  fittedParams = optParams.array().log().matrix();
+  fittedNLML = std::numeric_limits<double>::infinity();
+  if ( factorInfo.success )
+    {
+      bool mixed = mixedPrecision;
+      mixedPrecision = false;
+      auto & entry = evalCache.insert(fittedParams, evalMode());
+      entry.value = 0.5*( obsY.col(0).dot(alpha.col(0)) + n*std::log(2*PI) ) + cholFactor.diagonal().array().log().sum();
+      fittedNLML = entry.value/n;
+      mixedPrecision = mixed;
+    }
 
   // Assign tuned parameters to model
   if (!fixedNoise)
@@ -631,21 +3106,83 @@ void GP::GaussianProcess::fitModel()
     {
       std::cout << "\n Time Diagnostics |\n";
       std::cout << "------------------\n";
-      std::cout << "computeCov():\t  " << time_computecov/gradientEvals  << std::endl;
-      std::cout << "cholesky.llt():\t  " << time_cholesky_llt/gradientEvals  << std::endl;
-      std::cout << "_alpha term:\t  " << time_alpha/gradientEvals  << std::endl;
-      std::cout << "NLML:\t  \t  " << time_NLML/gradientEvals  << std::endl;
+      std::cout << "computeCov():\t  " << time_computecov/functionEvals  << std::endl;
+      std::cout << "cholesky.llt():\t  " << time_cholesky_llt/functionEvals  << std::endl;
+      std::cout << "_alpha term:\t  " << time_alpha/functionEvals  << std::endl;
+      std::cout << "NLML:\t  \t  " << time_NLML/functionEvals  << std::endl;
       std::cout << "Grad term:\t  " << time_term/gradientEvals  << std::endl;
       std::cout << "Gradient:\t  " << time_grad/gradientEvals  << std::endl;
-      std::cout << "\nEvaluation:\t  " << time_evaluation/gradientEvals  << std::endl;
+      std::cout << "\nEvaluation:\t  " << time_evaluation/functionEvals  << std::endl;
     }
     
 };
 
 
+// Fit the hyperparameters on growing random subsets of the observations  [ the subsets are nested and each stage continues from
+//   the previous one; returns false when no stage is smaller than the observation count ]
+bool GP::GaussianProcess::fitSubsamples()
+{
+  auto n = static_cast<int>(obsX.rows());
+  std::vector<int> sizes;
+  for ( auto size : subsampleSizes )
+    {
+      if ( ( size > 0 ) && ( size < n ) && ( sizes.empty() || ( size > sizes.back() ) ) )
+        sizes.push_back(size);
+    }
+  if ( sizes.empty() || fixedParams )
+    return false;
+
+  // Draw the subsets from one random permutation of the observations
+  std::vector<int> order(n);
+  std::iota(order.begin(), order.end(), 0);
+  std::mt19937 generator(static_cast<unsigned>(std::rand()));
+  std::shuffle(order.begin(), order.end(), generator);
+
+  // Fit each subset with the solver settings of this model  [ the first stage runs the restarts and screening,
+  //   later stages continue from the previous one ]
+  GaussianProcess stage;
+  stage.shareModel(*this);
+  stage.sharedDist = nullptr;
+  stage.threadConfig = threadConfig;
+  stage.lowerBounds = lowerBounds;
+  stage.upperBounds = upperBounds;
+  stage.fixedBounds = fixedBounds;
+  stage.solverPrecision = solverPrecision;
+  stage.solverRestarts = solverRestarts;
+  stage.initParamSearchCount = initParamSearchCount;
+  stage.initialParams = initialParams;
+  for ( auto k : boost::irange(0,static_cast<int>(sizes.size())) )
+    {
+      Matrix X(sizes[k], obsX.cols());
+      Matrix y(sizes[k], obsY.cols());
+      for ( auto i : boost::irange(0,sizes[k]) )
+        {
+          X.row(i) = obsX.row(order[i]);
+          y.row(i) = obsY.row(order[i]);
+        }
+      stage.setObs(X, y);
+      stage.setWarmStart(k > 0, warmTolerance);
+      int evals = stage.functionEvals;
+      time start = high_resolution_clock::now();
+      stage.fitModel();
+      time end = high_resolution_clock::now();
+      if ( VERBOSE )
+        std::cout << "\n[*] Subset Stage = " << sizes[k] << " observations  ( " << stage.functionEvals - evals
+                  << " evaluations, " << getTime(start, end) << " s )" <<std::endl;
+    }
+
+  // Continue from the hyperparameters of the last stage
+  fittedParams = stage.fittedParams;
+  return true;
+}
+
+
 // Compute predicted values
 void GP::GaussianProcess::predict()
 {
+  // Apply the model thread budget
+  ThreadScope threads(threadConfig);
+
   // Get matrix input observation count
   auto n = static_cast<int>(obsX.rows());
   auto m = static_cast<int>(predX.rows());
@@ -666,10 +3203,9 @@ void GP::GaussianProcess::predict()
   kstarmat *= scalingLevel;
 
   // Set predictive means/variances and compute negative log marginal likelihood
-  Matrix cholMat(cholesky.matrixL());
   //predMean.noalias() = kstar_and_v.transpose() * _alpha;
   predMean.noalias() = kstar_and_v.transpose() * alpha;
-  cholMat.triangularView<Eigen::Lower>().solveInPlace(kstar_and_v);  // kstar_and_v is now 'v'
+  triangularSolve(cholFactor, kstar_and_v);  // kstar_and_v is now 'v'
   predCov.noalias() = kstarmat - kstar_and_v.transpose() * kstar_and_v;
 
 }
@@ -678,6 +3214,9 @@ void GP::GaussianProcess::predict()
 // Draw sample paths from posterior distribution
 Matrix GP::GaussianProcess::getSamples(int count)
 {
+  // Apply the model thread budget
+  ThreadScope threads(threadConfig);
+
   // Get number of target points
   auto n = static_cast<int>(predX.rows());
   
@@ -707,6 +3246,9 @@ Matrix GP::GaussianProcess::getSamples(int count)
 // Evaluate NLML [public interface]
 double GP::GaussianProcess::computeNLML(const Vector & p)
 {
+  // Apply the model thread budget
+  ThreadScope threads(threadConfig);
+
   // Compute log-hyperparameters
   Vector logparams(augParamCount);
 
@@ -716,8 +3258,19 @@ double GP::GaussianProcess::computeNLML(const Vector & p)
   for ( auto i : boost::irange(index,augParamCount) )
     logparams(i) = std::log(p(i-index));
 
-  // Evaluate NLML using log-hyperparameters
-  return evalNLML(logparams);
+  // Evaluate NLML using log-hyperparameters  [ always in double precision ]
+  bool mixed = mixedPrecision;
+  mixedPrecision = false;
+  double value = evalNLML(logparams);
+  mixedPrecision = mixed;
+
+  // Keep only the Cholesky factor resident in low-memory mode
+  if ( lowMemory )
+    {
+      workspace.K.resize(0,0);
+      workspace.cacheValid = false;
+    }
+  return value;
 }
 
 
@@ -730,6 +3283,17 @@ double GP::GaussianProcess::computeNLML()
 
 
 
+// Evaluate NLML for specified noise and scaling levels with the current kernel parameters [public interface]
+//  [ After one eigendecomposition of the kernel matrix each evaluation is O(n), e.g. for grid searches ]
+double GP::GaussianProcess::computeNLML(double noise, double scaling)
+{
+  ThreadScope threads(threadConfig);
+  updateSpectrum();
+  return spectralNLML(noise, scaling, nullptr, nullptr);
+}
+
+
+
 // Define function for uniform sampling
 Matrix GP::sampleUnif(double a, double b, int N, int dim)
 {
@@ -738,6 +3302,49 @@ Matrix GP::sampleUnif(double a, double b, int N, int dim)
 }
 
 
+// Define Halton sequence design in the box [lbs, ubs]  [ one point per row; the first point of the sequence (the lower corner) is skipped ]
+Matrix GP::sampleHalton(int count, const Vector & lbs, const Vector & ubs)
+{
+  auto dim = static_cast<int>(lbs.rows());
+  Matrix design(count, dim);
+  int base = 1;
+  for ( auto j : boost::irange(0,dim) )
+    {
+      // Use the j-th prime as the base of dimension j
+      bool prime = false;
+      while ( !prime )
+        {
+          base += 1;
+          prime = true;
+          for ( int d = 2; d*d <= base; d++ )
+            prime = prime && ( base % d != 0 );
+        }
+
+      // Reflect the digits of the point index about the radix point
+      for ( auto i : boost::irange(0,count) )
+        {
+          double value = 0.0;
+          double fraction = 1.0/base;
+          for ( int index = i+1; index > 0; index /= base, fraction /= base )
+            value += fraction * ( index % base );
+          design(i,j) = lbs(j) + (ubs(j) - lbs(j)) * value;
+        }
+    }
+  return design;
+}
+
+
+// Define function for uniform sampling [Vectors, independent random stream]
+Vector GP::sampleUnifVector(const Vector & lbs, const Vector & ubs, std::mt19937 & generator)
+{
+  std::uniform_real_distribution<double> uniform(0.0, 1.0);
+  Vector sampleVector(lbs.rows());
+  for ( auto i : boost::irange(0,static_cast<int>(lbs.rows())) )
+    sampleVector(i) = lbs(i) + (ubs(i) - lbs(i)) * uniform(generator);
+  return sampleVector;
+}
+
+
 // Define function for uniform sampling [Vectors]
 Vector GP::sampleUnifVector(Vector lbs, Vector ubs)
 {
@@ -836,14 +3443,11 @@ float GP::getTime(std::chrono::high_resolution_clock::time_point start, std::chr
 
 
 // Define utility function for formatting hyperparameter bounds
-void GP::GaussianProcess::parseBounds(Vector & lbs, Vector & ubs, int augParamCount)
+void GP::GaussianProcess::parseBounds(Vector & lbs, Vector & ubs, int augParamCount, double defaultLowerBound, double defaultUpperBound)
 {
   lbs.resize(augParamCount);
   ubs.resize(augParamCount);
 
-  double defaultLowerBound = 0.01;
-  double defaultUpperBound = 2.0;
-  
   if ( fixedBounds )
     {
       // Check if bounds for noise parameter were provided
@@ -5,9 +5,22 @@
 #include <memory>
 #include <chrono>
 #include <cmath>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <type_traits>
+#include <random>
+#include <limits>
+#include <stdexcept>
+#include <algorithm>
+#include <array>
 #include <Eigen/Dense>
 
 #include "./include/LBFGS++/LBFGS.h"
+#include "./include/LBFGS++/LBFGSB.h"
 
 
 // Declare namespace for Gaussian process definitions
@@ -19,6 +32,7 @@ namespace GP {
   // Define aliases with using declarations
   using Matrix = Eigen::MatrixXd;
   using Vector = Eigen::VectorXd;
+  using MatrixF = Eigen::MatrixXf;
 
   // Define function for retrieving time from chrono
   float getTime(std::chrono::high_resolution_clock::time_point start, std::chrono::high_resolution_clock::time_point end);
@@ -31,12 +45,221 @@ namespace GP {
   // Define function for sampling uniform distribution on interval
   Matrix sampleUnif(double a=0.0, double b=1.0, int N=1, int dim=1);
   Vector sampleUnifVector(Vector lbs, Vector ubs);
+  Vector sampleUnifVector(const Vector & lbs, const Vector & ubs, std::mt19937 & generator);
+  Matrix sampleHalton(int count, const Vector & lbs, const Vector & ubs);
   Matrix sampleNormal(int N=1);
   
   // Define utility functions for computing distance matrices
   void pdist(Matrix & Dv, Matrix & X1, Matrix & X2);
   void squareForm(Matrix & D, Matrix & Dv, int n, double diagVal=0.0);
 
+  // Define dense squared distance matrix computed via norms and a single GEMM
+  void sqDist(Matrix & D, const Matrix & X1, const Matrix & X2);
+
+  // Define dense linear algebra backends [ LAPACKE/OpenBLAS is only available when compiled with GP_USE_LAPACKE ]
+  enum class Backend { Eigen, Lapacke };
+#ifdef GP_USE_LAPACKE
+  static const Backend DEFAULT_BACKEND = Backend::Lapacke;
+#else
+  static const Backend DEFAULT_BACKEND = Backend::Eigen;
+#endif
+  const char * backendName(Backend backend=DEFAULT_BACKEND);
+  bool backendAvailable(Backend backend);
+
+  // Factor a symmetric positive definite matrix in place  [ lower triangle holds L; returns false if A is not positive definite ]
+  // [ For the Eigen backend tileSize selects the task-parallel tiled factorization: 0 = automatic, >= n = Eigen LLT ]
+  // [ A graph passed by the caller is reused by tiled factorizations of the same tile count instead of being rebuilt ]
+  class TaskGraph;
+  bool choleskyFactor(Matrix & A, Backend backend=DEFAULT_BACKEND, int tileSize=0, TaskGraph * graph=nullptr);
+  bool choleskyFactor(MatrixF & A, Backend backend=DEFAULT_BACKEND, int tileSize=0, TaskGraph * graph=nullptr);
+
+  // Factor A in place as a graph of POTRF/TRSM/SYRK/GEMM tile tasks on the thread pool (right-looking)
+  bool tiledCholesky(Matrix & A, int tileSize, TaskGraph * graph=nullptr);
+  bool tiledCholesky(MatrixF & A, int tileSize, TaskGraph * graph=nullptr);
+  int defaultTileSize(int n, int threadCount);
+
+  // Define report returned by robustCholesky
+  struct CholeskyInfo
+  {
+    bool success = false;  // Factorization succeeded with an acceptable condition estimate
+    double jitter = 0.0;   // Diagonal jitter added in place by the final attempt [ on top of any jitter already in A ]
+    double scale = 0.0;    // Mean diagonal of A, to which the escalated jitter is proportional
+    int attempts = 0;      // Number of factorizations performed
+    double rcond = 0.0;    // Reciprocal condition estimate  (min L_ii / max L_ii)^2  [ an upper bound on 1/cond(A) ]
+  };
+
+  // Factor A in place, adding escalating diagonal jitter  jitter * mean(diag A) * 10^k  until the factorization succeeds
+  // [ Attempts with rcond < n*eps are treated as failures.  The strict upper triangle of A must hold the matrix (mirror=true
+  //   copies it from the lower triangle first); it is never written, so A is restored from it and the diagonal saved in
+  //   'diagonal' (or a local buffer when none is given) ]
+  CholeskyInfo robustCholesky(Matrix & A, double jitter, int maxAttempts=8, bool mirror=false, Backend backend=DEFAULT_BACKEND, int tileSize=0,
+                              TaskGraph * graph=nullptr, Vector * diagonal=nullptr);
+
+  // Solve  (L L^T) X = B  and  L X = B  in place for Cholesky factor L stored in the lower triangle
+  void choleskySolve(const Matrix & L, Matrix & B, Backend backend=DEFAULT_BACKEND);
+  void triangularSolve(const Matrix & L, Matrix & B, Backend backend=DEFAULT_BACKEND);
+
+  // Compute the eigenvalues (ascending) and eigenvectors of a symmetric matrix  [ A is overwritten by the eigenvectors; only its lower triangle is referenced ]
+  void symmetricEigen(Matrix & A, Vector & eigenvalues, Backend backend=DEFAULT_BACKEND);
+
+  // Define blocked inverse of a symmetric positive definite matrix from its Cholesky factor  [ equivalent to LAPACK potri ]
+  // [ Only the lower triangle of L is referenced and only the lower triangle of Kinv is defined on exit;
+  //   L and Kinv may be the same matrix, in which case the strict upper triangle is used as scratch space ]
+  void spdInverse(const Matrix & L, Matrix & Kinv, int blockSize=64, Backend backend=DEFAULT_BACKEND);
+  void spdInverse(const MatrixF & L, MatrixF & Kinv, int blockSize=64, Backend backend=DEFAULT_BACKEND);
+
+  // Define vectorized exponential  y = b * exp(a*x)  [ AVX-512 / AVX2 / scalar path selected at runtime ]
+  void vexp(const double * x, double * y, std::size_t count, double a=1.0, double b=1.0);
+  const char * vexpISA();
+
+  
+  // Define non-owning reference to a loop body fn(start,end) [ avoids std::function allocations per loop ]
+  class LoopBody
+  {
+  public:
+    template <typename Fn, typename = typename std::enable_if<!std::is_same<typename std::decay<Fn>::type, LoopBody>::value>::type>
+    LoopBody(Fn && fn)
+      : object(const_cast<void*>(static_cast<const void*>(&fn))),
+        invoke([](void * f, int start, int end) { (*static_cast<typename std::remove_reference<Fn>::type *>(f))(start, end); }) { }
+    void operator()(int start, int end) const { invoke(object, start, end); }
+  private:
+    void * object;
+    void (*invoke)(void *, int, int);
+  };
+
+  
+  // Define persistent work-stealing thread pool used by all parallel loops in the library
+  class ThreadPool
+  {
+  public:
+    using Task = std::function<void()>;
+
+    // Constructor and destructor [ threadCount counts the calling thread, which also executes tasks ]
+    explicit ThreadPool(int threadCount=0, bool pin=false);
+    ~ThreadPool();
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool & operator=(const ThreadPool &) = delete;
+
+    // Queue a task [ tasks submitted from a worker are pushed onto that worker's own deque ]
+    void submit(Task task);
+
+    // Execute one queued task on the calling thread; returns false if no task was available
+    bool runPending();
+
+    // Apply fn(start,end) to chunks of [begin,end) using dynamic scheduling on at most 'width' threads
+    void parallelFor(int begin, int end, int chunk, LoopBody fn, int width=0);
+
+    // Pin each worker thread to a single core of the process affinity mask (Linux only)  [ false if any pin failed ]
+    bool pinThreads();
+
+    // Get the number of threads available to parallel loops (including the caller)
+    int size() const { return static_cast<int>(workers.size()) + 1; }
+
+    // Get the default width of parallel loops started on the calling thread [ limited by the active ThreadConfig ]
+    int width() const;
+
+  private:
+    struct Queue { std::deque<Task> tasks; std::mutex mutex; };
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> workers;
+    std::atomic<bool> stopping{false};
+    std::atomic<int> queued{0};
+    std::atomic<unsigned> nextQueue{0};
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+    bool popTask(int index, Task & task);
+    void workerLoop(int index);
+  };
+
+  // Retrieve the library-owned thread pool
+  ThreadPool & threadPool();
+
+  // Define thread budget for a model, shared between BLAS-level (Eigen/OpenMP) and task-level (thread pool) parallelism
+  // [ The two levels run in alternating phases of an evaluation, so each may use up to 'totalThreads' ]
+  struct ThreadConfig
+  {
+    int totalThreads = 0;    // Total thread budget   [ 0 = available cores divided among concurrently running models ]
+    int blasThreads = 0;     // Eigen GEMM/LLT threads [ 0 = totalThreads ]
+    int taskThreads = 0;     // Thread pool loop width [ 0 = totalThreads ]
+    bool pinThreads = false; // Pin thread pool workers to cores
+  };
+
+  // Count the cores available to this process (affinity mask / OMP_NUM_THREADS aware)
+  int availableCores();
+
+  // Get the physical memory of the host in bytes  [ 0 if unknown ]
+  double physicalMemory();
+
+  // Apply a thread budget to the calling thread for the lifetime of the scope
+  class ThreadScope
+  {
+  public:
+    explicit ThreadScope(const ThreadConfig & config);
+    ~ThreadScope();
+    ThreadScope(const ThreadScope &) = delete;
+    ThreadScope & operator=(const ThreadScope &) = delete;
+
+    // Resolve automatic (zero) entries of a configuration for the current number of active models
+    static ThreadConfig resolve(const ThreadConfig & config);
+
+  private:
+    int previousWidth;
+    int previousBlas;
+  };
+
+  // Define reusable task graph for running dependent tasks on the thread pool
+  // [ Tasks are identified by index and carry a few integer arguments; the graph keeps its storage between runs, so that
+  //   running it again does not allocate.  A graph must not be run from two threads at once ]
+  class TaskGraph
+  {
+  public:
+    using Args = std::array<int,4>;
+
+    // Add a task and return its index [ ready tasks with higher priority are started first ]
+    int addTask(const Args & args, int priority=0);
+
+    // Specify that 'task' may only start after 'prerequisite' has completed
+    void addDependency(int task, int prerequisite);
+
+    // Remove all tasks
+    void clear() { nodes.clear(); }
+
+    // Get the number of tasks and the arguments of a task
+    int size() const { return static_cast<int>(nodes.size()); }
+    const Args & args(int task) const { return nodes[task].args; }
+
+    // Execute fn(task,task+1) for all tasks respecting dependencies on at most pool.width() threads; the calling thread participates until completion
+    void run(LoopBody fn, ThreadPool & pool = threadPool());
+
+  private:
+    struct Node { Args args; std::vector<int> successors; int dependencies = 0; int priority = 0; };
+    std::vector<Node> nodes;
+    std::vector<int> remaining;              // Unfinished prerequisites per task during a run
+    std::vector<std::pair<int,int>> ready;   // Heap of ready tasks ordered by priority, then by insertion order
+  };
+
+  
+  // Define read-only view of squared distances between observations
+  // [ Distances are either read from a dense cached matrix or evaluated from the inputs on demand (O(n) memory) ]
+  class DistanceView
+  {
+  public:
+    DistanceView(const Matrix & D) : dense(&D), inputs(nullptr) { }
+    static DistanceView fromInputs(const Matrix & X) { return DistanceView(nullptr, &X); }
+
+    // Get the number of observations
+    int size() const { return static_cast<int>( dense ? dense->rows() : inputs->rows() ); }
+
+    // Get squared distances from observation j to observations r0,...,r0+len-1
+    // [ The buffer is only written when distances are evaluated on demand ]
+    const double * segment(int j, int r0, int len, double * buffer) const;
+
+  private:
+    DistanceView(const Matrix * D, const Matrix * X) : dense(D), inputs(X) { }
+    const Matrix * dense;
+    const Matrix * inputs;
+  };
+
   
   // Define abstract base class for covariance kernels
   class Kernel 
@@ -47,8 +270,27 @@ namespace GP {
     Kernel(Vector p, int c) : kernelParams(p) , paramCount(c) { };
     virtual ~Kernel() = default;
 
-    // Compute the covariance matrix provided input observations and kernel hyperparameters
-    virtual void computeCov(Matrix & K, Matrix & obsX, Vector & params, std::vector<Matrix> & gradList, double jitter, bool evalGrad) =0;
+    // Compute the covariance matrix provided squared distances between observations and kernel hyperparameters
+    // [ The distance matrix D is owned by the GaussianProcess and is treated as read-only ]
+    virtual void computeCov(Matrix & K, const Matrix & D, Vector & params, double jitter) =0;
+
+    // Compute only the lower triangle of the covariance matrix [ used when distances are not cached ]
+    virtual void computeCovLower(Matrix & K, const DistanceView & D, Vector & params, double jitter);
+    virtual void computeCovLower(MatrixF & K, const DistanceView & D, Vector & params, double jitter);
+
+    // Compute Y = K*X without forming K [ entries are evaluated in double precision; returns the infinity norm of K ]
+    virtual double applyCov(const DistanceView & D, Vector & params, double jitter, const Matrix & X, Matrix & Y);
+
+    // Compute traces  trace[ term * dK/dlog(theta_i) ]  for all kernel hyperparameters in a single sweep over term
+    // [ Derivative matrices are evaluated on the fly from D and only the lower triangle of term is referenced ]
+    virtual void computeGradTraces(const Matrix & term, const DistanceView & D, Vector & params, Vector & traces, std::vector<double> & partials);
+    virtual void computeGradTraces(const MatrixF & term, const DistanceView & D, Vector & params, Vector & traces, std::vector<double> & partials);
+
+    // Compute the derivative matrices  dK/dlog(theta_i)  of all kernel hyperparameters  [ full matrices, used for Fisher scoring ]
+    virtual void computeCovDerivatives(std::vector<Matrix> & dK, const Matrix & D, Vector & params);
+
+    // Compute traces  trace[ term * d^2K/dlog(theta_i)dlog(theta_j) ]  for all pairs of kernel hyperparameters  [ row-major in traces ]
+    virtual void computeHessTraces(const Matrix & term, const DistanceView & D, Vector & params, Vector & traces, std::vector<double> & partials);
 
     // Compute the (cross-)covariance matrix for specified input vectors X1 and X2
     virtual void computeCrossCov(Matrix & K, Matrix & X1, Matrix & X2, Vector & params) = 0;
@@ -75,9 +317,16 @@ namespace GP {
     bool fixedScaling = false;
     //double parseParams(const Vector & params, Vector & kernelParams);
     //std::vector<double> parseParams(const Vector & params, Vector & kernelParams);
-    void parseParams(const Vector & params, Vector & kernelParams, std::vector<double> & nonKernelParams);
+    void parseParams(const Vector & params, double & noise, double & scaling);
     //virtual double evalKernel(Matrix&, Matrix&, Vector&, int) = 0;
+    // [ Derivative index n:  0 = kernel,  i+1 = d/dlog(theta_i),  paramCount+1 + i*paramCount+j = d^2/dlog(theta_i)dlog(theta_j) ]
     virtual double evalDistKernel(double, Vector&, int) = 0;
+    virtual void evalDistKernel(const double *, double *, std::size_t, const Eigen::Ref<const Vector>&, int) = 0;
+
+    // Shared single/double precision implementations
+    template <typename MatrixType> void covLower(MatrixType & K, const DistanceView & D, Vector & params, double jitter);
+    template <typename MatrixType> void gradTraces(const MatrixType & term, const DistanceView & D, Vector & params, Vector & traces, std::vector<double> & partials,
+                                                   int first, int count);
   };
 
 
@@ -89,8 +338,8 @@ namespace GP {
     // Constructor
     RBF() : Kernel(Vector(1), 1) { kernelParams(0)=1.0; };
     
-    // Compute the covariance matrix provided input observations and kernel hyperparameters
-    void computeCov(Matrix & K, Matrix & obsX, Vector & params, std::vector<Matrix> & gradList, double jitter, bool evalGrad);
+    // Compute the covariance matrix provided squared distances between observations and kernel hyperparameters
+    void computeCov(Matrix & K, const Matrix & D, Vector & params, double jitter);
     // Compute the (cross-)covariance matrix for specified input vectors X1 and X2
     void computeCrossCov(Matrix & K, Matrix & X1, Matrix & X2, Vector & params);
     
@@ -99,14 +348,347 @@ namespace GP {
     // Functions for evaluating the kernel on a pair of points / a specified squared distance
     //double evalKernel(Matrix&, Matrix&, Vector&, int);
     double evalDistKernel(double, Vector&, int);
+    void evalDistKernel(const double *, double *, std::size_t, const Eigen::Ref<const Vector>&, int);
     
   };
 
 
 
+  // Define backtracking line search for LBFGS++ which only evaluates the objective value at trial points
+  // [ The gradient is requested once a step satisfies the Armijo condition, so that rejected trials cost a single Cholesky
+  //   factorization; the objective must provide value(x), gradient(x, grad) and iteration(x, fx), where gradient(x, grad) may
+  //   reuse the work done by value(x) and iteration(x, fx) is called on the step returned.  Steps which fail the curvature
+  //   condition are extended, since L-BFGS updates require s^T y > 0 ]
+  template <typename Scalar>
+  class ValueFirstLineSearch
+  {
+  public:
+    using Vector = Eigen::Matrix<Scalar, Eigen::Dynamic, 1>;
+
+    template <typename Foo, typename SolverParam>
+    static void LineSearch(Foo & f, const SolverParam & param, const Vector & xp, const Vector & drt,
+                           const Scalar & step_max, Scalar & step, Scalar & fx, Vector & grad, Scalar & dg, Vector & x)
+    {
+      const Scalar fx_init = fx;
+      const Scalar dg_init = dg;
+      if ( dg_init > 0 )
+        throw std::logic_error("the moving direction increases the objective function value");
+      if ( step <= Scalar(0) )
+        throw std::invalid_argument("'step' must be positive");
+
+      // Bracket [lo, hi] between the longest step known to satisfy the Armijo condition and the shortest known to violate it
+      Scalar lo = 0;
+      Scalar hi = std::numeric_limits<Scalar>::infinity();
+      Scalar fxLo = fx_init, dgLo = dg_init;
+      Vector xLo, gradLo;
+      step = std::min(step, step_max);
+
+      for ( int iter = 0; iter < param.max_linesearch; iter++ )
+        {
+          x.noalias() = xp + step * drt;
+          fx = f.value(x);
+
+          if ( !( fx <= fx_init + step * param.ftol * dg_init ) )
+            {
+              // Backtrack using the minimizer of the quadratic through fx_init, dg_init and fx  [ safeguarded to (0.1, 0.5) ]
+              hi = step;
+              Scalar width = hi - lo;
+              Scalar slope = ( lo > 0 ) ? dgLo : dg_init;
+              Scalar curvature = fx - ( ( lo > 0 ) ? fxLo : fx_init ) - slope * width;
+              Scalar t = ( std::isfinite(fx) && ( curvature > 0 ) ) ? -slope * width * width / ( 2 * curvature ) : Scalar(0.5) * width;
+              step = lo + std::min(std::max(t, Scalar(0.1) * width), Scalar(0.5) * width);
+              if ( step < param.min_step )
+                throw std::runtime_error("the line search step became smaller than the minimum value allowed");
+              continue;
+            }
+
+          // Sufficient decrease: evaluate the gradient and check the curvature condition
+          f.gradient(x, grad);
+          dg = grad.dot(drt);
+          if ( ( dg >= param.wolfe * dg_init ) || ( step >= step_max ) )
+            {
+              f.iteration(x, fx);
+              return;
+            }
+
+          // Extend the step, or bisect the bracket once a violating step is known
+          lo = step;
+          fxLo = fx;
+          dgLo = dg;
+          xLo = x;
+          gradLo = grad;
+          step = std::isfinite(hi) ? Scalar(0.5) * ( lo + hi ) : std::min(Scalar(2) * step, step_max);
+        }
+
+      // Fall back on the longest step satisfying the Armijo condition if it still gives s^T y > 0; otherwise x is left there
+      //   for callers which catch the exception  [ a pair with s^T y <= 0 would corrupt the L-BFGS two-loop recursion ]
+      if ( lo > 0 )
+        {
+          step = lo;
+          x = xLo;
+          fx = fxLo;
+          grad = gradLo;
+          dg = dgLo;
+          if ( dg > dg_init )
+            {
+              f.iteration(x, fx);
+              return;
+            }
+        }
+      throw std::runtime_error("the line search routine reached the maximum number of iterations");
+    }
+  };
+
+
+  // Define line search for expensive objectives which evaluates at most param.max_linesearch trial points
+  // [ Trial points are value-only as in ValueFirstLineSearch.  Backtracking steps minimize the cubic through the value and
+  //   slope at the lower end of the bracket and the two last rejected values (a quadratic after the first rejection), and
+  //   extensions minimize the cubic through the values and slopes of the two last accepted steps.  Once the budget is spent,
+  //   the longest step satisfying the Armijo condition is returned, or else the lowest trial point below the initial value,
+  //   provided that it satisfies s^T y > 0 ]
+  template <typename Scalar>
+  class BudgetLineSearch
+  {
+  public:
+    using Vector = Eigen::Matrix<Scalar, Eigen::Dynamic, 1>;
+
+    // Minimizer of  c3*t^3 + c2*t^2 + slope*t  through the values fa at t = a and fb at t = b (relative to t = 0), safeguarded
+    // to [lower, upper]  [ b <= 0 drops the cubic term, and models without an interior minimizer return the midpoint ]
+    static Scalar interpolate(Scalar slope, Scalar a, Scalar fa, Scalar b, Scalar fb, Scalar lower, Scalar upper)
+    {
+      Scalar ra = fa - slope * a;
+      Scalar c3 = 0, c2 = ra / ( a * a );
+      if ( ( b > a ) && std::isfinite(fb) )
+        {
+          Scalar rb = fb - slope * b;
+          Scalar denom = a * a * b * b * ( a - b );
+          c3 = ( b * b * ra - a * a * rb ) / denom;
+          c2 = ( a * a * a * rb - b * b * b * ra ) / denom;
+        }
+      Scalar radical = c2 * c2 - 3 * c3 * slope;
+      Scalar t = ( radical >= 0 ) ? -slope / ( c2 + std::sqrt(radical) ) : Scalar(-1);
+      if ( !std::isfinite(t) || ( t <= 0 ) )
+        t = Scalar(0.5) * ( lower + upper );
+      return std::min(std::max(t, lower), upper);
+    }
+
+    template <typename Foo, typename SolverParam>
+    static void LineSearch(Foo & f, const SolverParam & param, const Vector & xp, const Vector & drt,
+                           const Scalar & step_max, Scalar & step, Scalar & fx, Vector & grad, Scalar & dg, Vector & x)
+    {
+      const Scalar fx_init = fx;
+      const Scalar dg_init = dg;
+      if ( dg_init > 0 )
+        throw std::logic_error("the moving direction increases the objective function value");
+      if ( step <= Scalar(0) )
+        throw std::invalid_argument("'step' must be positive");
+
+      // Bracket [lo, hi] between the longest step known to satisfy the Armijo condition (with its value and slope) and the
+      // shortest rejected step; 'prev' is the previously rejected step beyond hi, and 'back' the accepted step before lo
+      const Scalar inf = std::numeric_limits<Scalar>::infinity();
+      Scalar lo = 0, fxLo = fx_init, dgLo = dg_init;
+      Scalar hi = inf, fxHi = inf, prev = inf, fxPrev = inf;
+      Scalar back = 0, fxBack = fx_init, dgBack = dg_init;
+      Scalar best = 0, fxBest = fx_init;
+      Vector xLo, gradLo;
+      step = std::min(step, step_max);
+
+      for ( int iter = 0; iter < param.max_linesearch; iter++ )
+        {
+          x.noalias() = xp + step * drt;
+          fx = f.value(x);
+
+          if ( !( fx <= fx_init + step * param.ftol * dg_init ) || !( fx < fxLo ) )
+            {
+              if ( ( lo == 0 ) && ( fx < fxBest ) )
+                {
+                  best = step;
+                  fxBest = fx;
+                }
+              prev = hi;
+              fxPrev = fxHi;
+              hi = step;
+              fxHi = fx;
+              Scalar width = hi - lo;
+              step = lo + interpolate(dgLo, width, fxHi - fxLo, prev - lo, fxPrev - fxLo, Scalar(0.1) * width,
+                                      ( lo > 0 ? Scalar(0.9) : Scalar(0.5) ) * width);
+              if ( step < param.min_step )
+                break;
+              continue;
+            }
+
+          // Sufficient decrease: evaluate the gradient and check the curvature condition
+          f.gradient(x, grad);
+          dg = grad.dot(drt);
+          if ( ( dg >= param.wolfe * dg_init ) || ( step >= step_max ) )
+            {
+              f.iteration(x, fx);
+              return;
+            }
+
+          back = lo;
+          fxBack = fxLo;
+          dgBack = dgLo;
+          lo = step;
+          fxLo = fx;
+          dgLo = dg;
+          xLo = x;
+          gradLo = grad;
+          if ( std::isfinite(hi) )
+            {
+              Scalar width = hi - lo;
+              step = lo + interpolate(dgLo, width, fxHi - fxLo, prev - lo, fxPrev - fxLo, Scalar(0.1) * width, Scalar(0.9) * width);
+            }
+          else
+            {
+              // Extrapolate with the cubic through the two last accepted steps  [ to between 1.1 and 4 times their distance ]
+              Scalar width = lo - back;
+              Scalar A = 6 * ( fxBack - fxLo ) + 3 * ( dgLo + dgBack ) * width;
+              Scalar B = 3 * ( fxLo - fxBack ) - ( 2 * dgBack + dgLo ) * width;
+              Scalar radical = B * B - A * dgBack * width;
+              Scalar t = ( radical >= 0 ) ? -dgBack * width * width / ( B + std::sqrt(radical) ) : inf;
+              if ( !std::isfinite(t) || ( t < 0 ) )
+                t = inf;
+              step = std::min(back + std::min(std::max(t, Scalar(1.1) * width), Scalar(4) * width), step_max);
+            }
+        }
+
+      // The budget is spent: fall back on the longest step satisfying the Armijo condition, or else on the lowest trial point
+      //   [ reusing its factorization when it was the last point evaluated ].  The fallback is only returned if it gives
+      //   s^T y > 0, as required by the L-BFGS updates; otherwise x is left there for callers which catch the exception
+      if ( ( lo > 0 ) || ( best > 0 ) )
+        {
+          step = ( lo > 0 ) ? lo : best;
+          if ( lo > 0 )
+            {
+              x = xLo;
+              fx = fxLo;
+              grad = gradLo;
+            }
+          else
+            {
+              x.noalias() = xp + step * drt;
+              fx = fxBest;
+              f.gradient(x, grad);
+            }
+          dg = grad.dot(drt);
+          if ( dg > dg_init )
+            {
+              f.iteration(x, fx);
+              return;
+            }
+        }
+      throw std::runtime_error("the line search routine reached the maximum number of iterations");
+    }
+  };
+
+
+  // Define hyperparameter optimizers  [ ConjugateGradient is Rasmussen's minimize.m (see misc/minimize.cpp); the CppOptLib
+  //   L-BFGS-B solver is only available when compiled with GP_USE_CPPOPTLIB (see include/README.md) ]
+  enum class Optimizer { LBFGS, LBFGSB, FisherScoring, ConjugateGradient, CppOptLib };
+  const char * optimizerName(Optimizer optimizer);
+  bool optimizerAvailable(Optimizer optimizer);
+
+  // Define the evaluation callback shared by all optimizers
+  // [ value(x) is used for line search trial points, and gradient(x, grad) may reuse the work done by value(x).  iteration(x, fx)
+  //   is called once per accepted iterate, after its gradient has been evaluated ]
+  class Objective
+  {
+  public:
+    virtual ~Objective() = default;
+    virtual double value(const Vector & x) = 0;
+    virtual void gradient(const Vector & x, Vector & grad) = 0;
+    virtual double operator()(const Vector & x, Vector & grad) { double fx = value(x); gradient(x, grad); return fx; }
+    virtual void iteration(const Vector & x, double fx) { }
+  };
+
+  // Define stopping criteria shared by all optimizers
+  struct SolverOptions
+  {
+    int maxIterations = 100;   // Iteration (line search) limit
+    int maxLinesearch = 20;    // Evaluation limit per line search
+    double epsilon = 1e-5;     // Projected gradient tolerance
+    int past = 1;              // Distance (in iterations) of the relative reduction test  [ 0 disables the test ]
+    double delta = 0.0;        // Relative reduction tolerance
+    int memory = 10;           // Correction pairs of the limited-memory solvers
+    int lineSearchBudget = 0;  // Trial points per line search of the budgeted line search  [ 0 selects the default line search ]
+  };
+
+  // Minimize an objective with the specified optimizer and return the iteration count
+  // [ the bounded optimizers keep x within (lbs, ubs), while L-BFGS and conjugate gradients ignore the bounds; Fisher scoring
+  //   requires the gradient term of a GaussianProcess and is run by fitModel itself.  The budgeted line search replaces the
+  //   line searches of L-BFGS, L-BFGS-B and conjugate gradients; CppOptLib keeps its More-Thuente line search ]
+  int minimizeObjective(Optimizer optimizer, Objective & objective, Vector & x, double & fx, const Vector & lbs, const Vector & ubs,
+                        const SolverOptions & options);
+
+  
+  // Define reusable buffers for NLML evaluations [ sized once per fit and reused by every iteration ]
+  struct Workspace
+  {
+    Vector params;                 // Hyperparameters (exponentiated)
+    Matrix K;                      // Covariance matrix, overwritten in place by its Cholesky factor
+    Matrix alpha;                  // Solution  K^-1 y
+    Matrix term;                   // Gradient term  K^-1 - alpha*alpha^T  [ lower triangle only; unused in low-memory mode ]
+    MatrixF Kf;                    // Single precision covariance matrix / Cholesky factor  [ mixed precision mode only ]
+    MatrixF termF;                 // Single precision gradient term  [ mixed precision mode only; unused in low-memory mode ]
+    Matrix residual;               // Refinement residual  y - K*alpha
+    Eigen::VectorXf correction;    // Single precision refinement correction
+    Vector traces;                 // Kernel hyperparameter gradient traces
+    std::vector<double> traceVals; // Partial trace sums (one padded block per chunk of columns)
+    Matrix inverse;                // Full inverse  K^-1  [ Fisher scoring only; sized on first use ]
+    std::vector<Matrix> derivs;    // Kernel hyperparameter derivative matrices  dK_i  [ Fisher scoring only ]
+    std::vector<Matrix> products;  // Products  K^-1 dK_i  for the kernel hyperparameters  [ Fisher scoring only ]
+    Matrix dKalpha;                // Products  dK_i alpha  for all free hyperparameters  [ Fisher scoring only ]
+    Matrix weighted;               // Products  K^-1 dK_i alpha  [ Fisher scoring only ]
+    Vector hessTraces;             // Second derivative traces of the kernel hyperparameters  [ Fisher scoring only ]
+    TaskGraph factorGraph;         // Tiled Cholesky task graph  [ rebuilt only when the tile count changes ]
+    Vector savedDiagonal;          // Diagonal of K saved by robustCholesky for jitter escalation
+
+    // Log-hyperparameters of the factorization held in K (or Kf), for a deferred gradient evaluation
+    Vector cachedParams;
+    bool cachedMixed = false;
+    double cachedYTalpha = 0.0;
+    double cachedJitter = 0.0;   // Escalated jitter relative to the mean diagonal of K
+    bool cacheValid = false;
+
+    // Allocate all buffers for n observations and the specified parameter counts
+    // [ In low-memory mode the gradient term is formed in place over K; in mixed precision mode the single precision buffers replace K and term.
+    //   Value-only workspaces omit the gradient term, which is then allocated by the first gradient evaluation ]
+    void resize(int n, int augParamCount, int paramCount, bool lowMemory=false, bool mixedPrecision=false, bool valueOnly=false);
+  };
+
+
+  // Define least-recently-used cache of NLML evaluations keyed by log-hyperparameters
+  // [ The Cholesky factor and alpha of the most recent evaluation are held by the workspace; entries are recycled in place,
+  //   so that steady-state evaluations do not allocate ]
+  struct EvalCache
+  {
+    struct Entry
+    {
+      Vector params;         // Log-hyperparameters  [ empty for unused entries ]
+      int mode = 0;          // Evaluation mode  [ mixed precision / profiled scaling ]
+      double value = 0.0;    // NLML
+      double scale = 1.0;    // Profiled scaling level
+      Vector grad;           // NLML gradient
+      bool hasGrad = false;
+      long stamp = 0;        // Time of last use
+    };
+    std::vector<Entry> entries;
+    long clock = 0;
+    int hits = 0;
+
+    explicit EvalCache(int capacity=8) : entries(capacity) { }
+
+    // Find the entry for params  [ up to round-off, e.g. from log(exp(params)) ], or insert it in place of the least recently used
+    Entry * find(const Vector & params, int mode);
+    Entry & insert(const Vector & params, int mode);
+    void erase(const Vector & params, int mode);
+    void clear();
+  };
+
   
   // Define class for Gaussian processes
-  class GaussianProcess
+  class GaussianProcess : public Objective
   {    
   public:
 
@@ -116,24 +698,49 @@ namespace GP {
     // Copy Constructor
     GaussianProcess(const GaussianProcess & m) { std::cout << "\n [*] WARNING: copy constructor called by GaussianProcess\n"; }
     
-    // Define LBFGS++ function call for optimization
-    double operator()(const Eigen::VectorXd& p, Eigen::VectorXd& g) { return evalNLML(p, g, true); }
+    // Define function call for optimization [ only noise/scaling are optimized when the kernel parameters are fixed ]
+    double operator()(const Eigen::VectorXd& p, Eigen::VectorXd& g) override { return fixedParams ? evalSpectralNLML(p, g, true) : evalNLML(p, g, true); }
+
+    // Define value-only and deferred gradient evaluations for line searches
+    // [ gradient(p) reuses the Cholesky factor from value(p) when p is the last point evaluated ]
+    double value(const Eigen::VectorXd& p) override;
+    void gradient(const Eigen::VectorXd& p, Eigen::VectorXd& g) override;
+
+    // Check accepted iterates of concurrent restarts for early abandonment
+    void iteration(const Eigen::VectorXd& p, double fx) override;
     
     // Set methods
-    void setObs(Matrix & x, Matrix & y) { obsX = x; obsY = y; } 
-    void setKernel(Kernel & k) { kernel = &k; }
+    void setObs(Matrix & x, Matrix & y) { obsX = x; obsY = y; distStale = true; spectrumStale = true; evalCache.clear(); } 
+    void setKernel(Kernel & k) { kernel = &k; evalCache.clear(); }
     void setPred(Matrix & px) { predX = px; }
-    void setNoise(double noise) { fixedNoise = true; noiseLevel = noise; }
+    void setNoise(double noise) { fixedNoise = true; noiseLevel = noise; evalCache.clear(); }
     void setBounds(Vector & lbs, Vector & ubs) { lowerBounds = lbs; upperBounds = ubs; fixedBounds=true; }
     void setSolverIterations(int i) { solverIterations = i; };
     void setSolverPrecision(double p) { solverPrecision = p; };
     void setSolverRestarts(int n) { solverRestarts = n; };
+    void setInitParamSearch(int count) { initParamSearchCount = count; }
+    void setOptimizer(Optimizer method) { optimizer = method; }
+    void setInitialParams(const Vector & params) { initialParams = params; }
+    void setWarmStart(bool warm=true, double tolerance=0.05) { warmStart = warm; warmTolerance = tolerance; }
+    void setSubsampleSchedule(const std::vector<int> & sizes, int iterations=5) { subsampleSizes = sizes; subsampleIterations = iterations; }
+    void setThreadConfig(const ThreadConfig & config) { threadConfig = config; }
+    void setLowMemory(bool lean=true) { lowMemory = lean; }
+    void setTileSize(int size) { tileSize = size; }
+    void setMixedPrecision(bool mixed=true) { mixedPrecision = mixed; }
+    void setJitterAttempts(int attempts) { maxJitterAttempts = attempts; }
+    void setFixedParams(bool fixed=true) { fixedParams = fixed; }
+    void setProfiledScaling(bool profiled=true) { profiledScaling = profiled; }
+    void setRestartAbandonment(int iterations, double margin=0.05) { abandonIterations = iterations; abandonMargin = margin; }
+    void setLineSearchBudget(int budget) { lineSearchBudget = budget; }
+    void setTaskMemory(double bytes) { taskMemory = bytes; }
+    void clearEvalCache() { evalCache.clear(); }   // Discard memoized evaluations  [ e.g. to time repeated evaluations at one point ]
 
     // Compute methods
     void fitModel();
     void predict();
     double computeNLML(const Vector & p);
     double computeNLML();
+    double computeNLML(double noise, double scaling);
     
     // Get methods    
     Matrix getPredMean() { return predMean; }
@@ -142,16 +749,27 @@ namespace GP {
     Vector getParams() { return (*kernel).getParams(); }
     double getNoise() { return noiseLevel; }
     double getScaling() { return scalingLevel; }
+    double getJitter() { return jitter + factorInfo.jitter; }
+    CholeskyInfo getFactorInfo() { return factorInfo; }
+    ThreadConfig getThreadConfig() { return ThreadScope::resolve(threadConfig); }
+    int getFunctionEvals() { return functionEvals; }
+    int getGradientEvals() { return gradientEvals; }
+    int getFisherEvals() { return fisherEvals; }
+    Optimizer getOptimizer() { return optimizer; }
     
 
   private:
 
     // Specify whether or not to display debugging and time diagnostic information
     bool VERBOSE = false;
+
+    // Thread budget applied to fitting, evaluation and prediction
+    ThreadConfig threadConfig;
     
     // Private member functions
     double evalNLML(const Vector & p); 
     double evalNLML(const Vector & p, Vector & g, bool evalGrad=false);
+    void evalGradient(Vector & g);
     
     // Kernel and covariance matrix
     Kernel * kernel;
@@ -161,18 +779,52 @@ namespace GP {
     bool fixedScaling = false;
     double jitter = 1e-10;
 
-    // Store Cholsky decomposition
-    Eigen::LLT<Matrix> cholesky;
+    // Store Cholsky decomposition [ lower triangle of cholFactor holds L ]
+    Matrix cholFactor;
+    int tileSize = 0;
+
+    // Report of the last double precision factorization [ jitter is escalated up to maxJitterAttempts-1 times ]
+    CholeskyInfo factorInfo;
+    int maxJitterAttempts = 8;
+    int jitterEscalations = 0;
 
     // Hyperparameter bounds
     Vector lowerBounds;
     Vector upperBounds;
     bool fixedBounds = false;
-    void parseBounds(Vector & lbs, Vector & ubs, int augParamCount);
+
+    // Hyperparameter optimizer  [ unavailable optimizers fall back to L-BFGS-B ]
+    Optimizer optimizer = Optimizer::LBFGSB;
+
+    // Trial points per line search  [ 0 selects the default line searches; see BudgetLineSearch ]
+    int lineSearchBudget = 0;
+
+    // Trust-region Fisher scoring: steps minimize a quadratic model of the NLML in the log-hyperparameters within a radius adapted
+    // to the agreement between predicted and actual reductions; the model uses the observed information (Hessian) where it is
+    // positive definite and the Fisher information otherwise
+    // [ requires the dense gradient term, so low-memory, mixed precision and fixed-parameter fits use L-BFGS-B; the scaling level is not profiled ]
+    void evalInformation(const Vector & g, Matrix & fisher, Matrix & hessian);
+    int minimizeFisher(Vector & theta, double & fx, const Vector & lbs, const Vector & ubs, const SolverOptions & options);
+
+    // Initial guess of the first restart  [ augmented layout (noise, scaling, kernel parameters) without fixed levels ]
+    Vector initialParams;
+
+    // Log-hyperparameters and NLML per observation of the last fit, from which a warm-started refit continues
+    bool warmStart = false;
+    double warmTolerance = 0.05;
+    Vector fittedParams;
+    double fittedNLML = std::numeric_limits<double>::infinity();
+
+    // Sizes of the nested random subsets fitted before the full observations, and the iterations run at full size
+    std::vector<int> subsampleSizes;
+    int subsampleIterations = 5;
+    bool fitSubsamples();
+    void parseBounds(Vector & lbs, Vector & ubs, int augParamCount, double defaultLowerBound=0.01, double defaultUpperBound=2.0);
     int solverIterations = 1000;
     //double solverPrecision = 1e8;
     double solverPrecision = 1e8;
     double solverRestarts = 0;
+    int initParamSearchCount = 0;
       
     // Store squared distance matrix and alpha for NLML/DNLML calculations
     Matrix alpha;
@@ -180,6 +832,64 @@ namespace GP {
     // Observation data
     Matrix obsX; 
     Matrix obsY; 
+
+    // Cached squared distance matrix for the observations [ rebuilt once per call to setObs ]
+    Matrix obsDist;
+    bool distStale = true;
+    void updateDistances();
+
+    // Low-memory mode: no distance cache, and the covariance, factor and gradient term share one n x n buffer
+    bool lowMemory = false;
+    DistanceView distances() { return lowMemory ? DistanceView::fromInputs(obsX) : DistanceView(distMatrix()); }
+
+    // Concurrent restarts evaluate on separate models which share the distance matrix of the fitted model
+    const Matrix * sharedDist = nullptr;
+    const Matrix & distMatrix() const { return sharedDist ? *sharedDist : obsDist; }
+    void shareModel(GaussianProcess & model);
+
+    // Restarts whose best NLML trails the best value found by the other restarts by more than  abandonMargin*max(1,|best|)
+    // after 'abandonIterations' iterations are abandoned  [ 0 disables abandonment; the leading restart is never abandoned,
+    //   and an abandoned restart keeps its best point as a candidate ]
+    struct RestartBoard
+    {
+      std::mutex mutex;
+      std::vector<double> best;
+    };
+    int abandonIterations = 5;
+    double abandonMargin = 0.05;
+    RestartBoard * restartBoard = nullptr;
+    int restartIndex = 0;
+    int restartIterations = 0;
+    double restartBestValue = 0.0;
+    Vector restartBestParams;
+
+    // Memory budget (bytes) for the workspaces of concurrently running restart and screening models
+    //   [ 0 = half of the physical memory; tasks run sequentially on this model when two workspaces exceed it ]
+    double taskMemory = 0.0;
+
+    // Fixed kernel parameters: with  K = scaling*K0 + noise*I  and  K0 = Q diag(lambda) Q^T,  the NLML and its noise/scaling
+    // gradients are evaluated in O(n) from lambda and Q^T y  [ the spectrum is recomputed when the observations or kernel parameters change ]
+    bool fixedParams = false;
+    bool spectrumStale = true;
+    Vector spectrumParams;
+    Vector eigenvalues;
+    Vector projectedY;
+    void updateSpectrum();
+    double spectralNLML(double noise, double scaling, double * gNoise, double * gScaling);
+    double evalSpectralNLML(const Vector & p, Vector & g, bool evalGrad=false);
+
+    // Profiled scaling: the scaling level is eliminated from the optimization using its closed-form optimum  s* = y^T K~^-1 y / n,
+    // where  K~ = K0 + noise*I  has unit scaling and the noise level is taken relative to the scaling level
+    // [ only applies when both the noise and scaling levels are free; 'profiling' is set while fitModel optimizes ]
+    bool profiledScaling = false;
+    bool profiling = false;
+    double profiledScale = 1.0;
+
+    // Mixed precision mode: single precision covariance, factor and gradient term, with alpha refined to double precision
+    // [ Evaluations whose refinement fails to converge are repeated in double precision ]
+    bool mixedPrecision = false;
+    int mixedFallbacks = 0;
+    bool refineAlpha(Workspace & ws, Vector & params);
     
     // Prediction data
     Matrix predX;
@@ -194,8 +904,12 @@ namespace GP {
     int paramCount;
     int augParamCount;
 
-    // Need to find a way to avoid creating new gradList each time...
-    std::vector<Matrix> gradList;  
+    // Reusable evaluation buffers
+    Workspace workspace;
+
+    // Memoized NLML values and gradients  [ repeated optimizer evaluations and post-fit queries are served from the cache ]
+    EvalCache evalCache;
+    int evalMode() const { return ( mixedPrecision ? 1 : 0 ) | ( profiling ? 2 : 0 ); }
 
     // DEFINE TIMER VARIABLES
     ///*
@@ -208,8 +922,10 @@ namespace GP {
     double time_evaluation = 0.0;
     //*/
     
-    // Count gradient evaluations by optimizer
+    // Count NLML and gradient evaluations by optimizer
+    int functionEvals = 0;
     int gradientEvals = 0;
+    int fisherEvals = 0;
 
   };
 
@@ -268,7 +268,8 @@ class LbfgsbSolver : public ISolver<TProblem, 1> {
 
       if ( info != 1 )
         {
-          std::cout << "\n[*] WARNING: Unexpected line-search exit status; re-evaluating... [ INFO = " << info << " ]\n";
+          if (this->m_debug > DebugLevel::None)
+            std::cout << "\n[*] WARNING: Unexpected line-search exit status; re-evaluating... [ INFO = " << info << " ]\n";
           f = problem.value(x);
           problem.gradient(x, g);
         }
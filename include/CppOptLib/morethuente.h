@@ -87,7 +87,9 @@ class MoreThuente {
     if (dginit >= 0.0) {
       // no descent direction
       // TODO: handle this case
+#ifdef CPPOPTLIB_DEBUG_LINESEARCH
       std::cout << "\n[*] Warning: no descent direction found (handling not yet implemented in cppoptlib)\n";
+#endif
       return -1;
     }
 
@@ -174,6 +176,7 @@ class MoreThuente {
         {
           //std::cout << "\n[*] Line Search Terminated\n";
           //std::cout << "Function Evaluations: " << nfev << "\t INFO = " << info << "\t x = " << x.transpose() << std::endl;
+#ifdef CPPOPTLIB_DEBUG_LINESEARCH
           double lhs = f;
           double rhs = ftest1;
           std::cout << "\nEnd of line search:\n";
@@ -182,6 +185,7 @@ class MoreThuente {
           rhs = gtol * (-dginit);
           std::cout << lhs << " < " << rhs << "\t [ gtol = "  << gtol << " ,  dginit = "  << dginit << " ]\n";
           std::cout << "function evals = " << nfev << "\t info = " << info << " \n";
+#endif
           return info;
           //return -1;
         }
@@ -0,0 +1,412 @@
+// Benchmarks.cpp -- timing comparisons for the linear algebra kernels used by CppGPs
+//
+//  Usage:  ./Benchmarks [obsCount] [repeats]
+//
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+#include <string>
+#include <cstdlib>
+#include <functional>
+#include <boost/range/irange.hpp>
+#include "../GPs.h"
+
+
+// Retrieve aliases from GP namescope
+using Matrix = Eigen::MatrixXd;
+using Vector = Eigen::VectorXd;
+
+
+// Form the gradient term  K^-1 - alpha*alpha^T  by solving against column blocks of the identity
+// [ Reference implementation used by evalNLML prior to GP::spdInverse ]
+void termColumnSolves(Eigen::LLT<Eigen::Ref<Matrix>> & cholesky, const Matrix & alpha, Matrix & term)
+{
+  auto n = static_cast<int>(alpha.rows());
+  term.setIdentity(n,n);
+  int threadCount = GP::threadPool().width();
+  int blockCols = std::max(32, n/(4*threadCount));
+  GP::threadPool().parallelFor(0, n, blockCols, [&term,&cholesky,n](int startCol, int endCol) {
+                                                  auto block = term.block(0,startCol,n,endCol-startCol);
+                                                  cholesky.solveInPlace(block);
+                                                });
+  term.noalias() -= alpha*alpha.transpose();
+}
+
+// Form the lower triangle of the gradient term using the blocked SPD inverse
+void termSPDInverse(const Matrix & L, const Matrix & alpha, Matrix & term)
+{
+  auto n = static_cast<int>(alpha.rows());
+  GP::spdInverse(L, term);
+  for ( auto j : boost::irange(0,n) )
+    term.col(j).tail(n-j) -= alpha(j,0) * alpha.col(0).tail(n-j);
+}
+
+
+// Define the target functions of the example problems in tests/
+double oscillatoryFunc(const Matrix & X)
+{
+  double xshifted = 0.5*(X(0) + 1.0);
+  return std::sin(30.0*(xshifted-0.1))*(0.5-(xshifted-0.1))*15.0;
+}
+
+double marrWavelet(const Matrix & X)
+{
+  double sigma = 0.25;
+  double pi = std::atan(1)*4;
+  double radialTerm = std::pow(X.squaredNorm()/sigma,2);
+  return 2.0 / (std::sqrt(pi*sigma) * std::pow(pi,1.0/4.0)) * (1.0 - radialTerm) * std::exp(-radialTerm);
+}
+
+double multiModalFunc(const Matrix & X)
+{
+  Matrix p1(1,2);  p1 << 0.25, 0.5;
+  Matrix p2(1,2);  p2 << -0.25, -0.5;
+  double radialTerm1 = ((X-p1)*(1/0.4)).squaredNorm();
+  double radialTerm2 = ((X-p2)*(1/0.3)).squaredNorm();
+  return 10.0*std::exp(-radialTerm1) + 15.0*std::exp(-radialTerm2);
+}
+
+// Define a pure noise target  [ the fitted scaling level vanishes, so that the iterates reach the lower bound of the solver box ]
+double noiseOnlyFunc(const Matrix &)
+{
+  return 0.0;
+}
+
+// Define an example problem and the results of fitting it
+struct FitProblem { const char * name; double (*target)(const Matrix &); int inputDim; int obsCount; double noiseLevel; int restarts; };
+struct FitResult { int functionEvals; int gradientEvals; int fisherEvals; double time; double nlml; };
+
+// Fit the hyperparameters of an example problem with the solver options set by 'configure'
+FitResult fitProblem(const FitProblem & problem, const std::function<void(GP::GaussianProcess &)> & configure)
+{
+  std::srand(static_cast<unsigned int>(0));
+  Matrix X = GP::sampleUnif(-1.0, 1.0, problem.obsCount, problem.inputDim);
+  Matrix noise = GP::sampleNormal(problem.obsCount) * problem.noiseLevel;
+  Matrix y(problem.obsCount, 1);
+  for ( auto i : boost::irange(0,problem.obsCount) )
+    y(i) = problem.target(X.row(i)) + noise(i);
+
+  GP::RBF kernel;
+  GP::GaussianProcess model;
+  model.setObs(X, y);
+  model.setKernel(kernel);
+  model.setSolverRestarts(problem.restarts);
+  configure(model);
+
+  GP::time start = GP::high_resolution_clock::now();
+  model.fitModel();
+  GP::time end = GP::high_resolution_clock::now();
+  return { model.getFunctionEvals(), model.getGradientEvals(), model.getFisherEvals(), GP::getTime(start, end), model.computeNLML() };
+}
+
+
+int main(int argc, char const *argv[])
+{
+
+  // Convenience using-declarations
+  using std::cout;
+  using std::endl;
+
+  // Used for timing code with chrono
+  using GP::high_resolution_clock;
+  using GP::time;
+  using GP::getTime;
+
+  // Specify problem size and number of timed repetitions
+  int obsCount = ( argc > 1 ) ? std::atoi(argv[1]) : 2000;
+  int repeats = ( argc > 2 ) ? std::atoi(argv[2]) : 3;
+
+  // Fix random seed so that runs are comparable
+  std::srand(static_cast<unsigned int>(0));
+
+  // Define observations and a well-conditioned RBF covariance matrix  [ params = (noise, scaling, length) ]
+  Matrix X = GP::sampleUnif(-1.0, 1.0, obsCount, 2);
+  Matrix y = GP::sampleNormal(obsCount);
+  Vector params(3);  params << 0.1, 1.0, 0.5;
+  GP::RBF kernel;
+  Matrix D;
+  GP::sqDist(D, X, X);
+
+  cout << "\nObservations:  " << obsCount << "\nThread pool:   " << GP::threadPool().size() << " threads\n";
+  cout << "Exponential:   " << GP::vexpISA() << endl;
+  cout << "Backend:       " << GP::backendName() << endl;
+
+
+  //
+  //   [ Gradient Term:  K^-1 - alpha*alpha^T ]
+  //
+
+  Matrix K, alpha, termSolve, termInverse;
+  double timeSolve = 0.0;
+  double timeInverse = 0.0;
+  double timeInPlace = 0.0;
+  for ( auto r : boost::irange(0,repeats) )
+    {
+      (void)r;
+      kernel.computeCov(K, D, params, 1e-10);
+      Eigen::LLT<Eigen::Ref<Matrix>> cholesky(K);
+      alpha = y;
+      cholesky.solveInPlace(alpha);
+
+      time start = high_resolution_clock::now();
+      termColumnSolves(cholesky, alpha, termSolve);
+      time end = high_resolution_clock::now();
+      timeSolve += getTime(start, end);
+
+      start = high_resolution_clock::now();
+      termSPDInverse(K, alpha, termInverse);
+      end = high_resolution_clock::now();
+      timeInverse += getTime(start, end);
+
+      // Low-memory mode overwrites the factor with the gradient term
+      start = high_resolution_clock::now();
+      termSPDInverse(K, alpha, K);
+      end = high_resolution_clock::now();
+      timeInPlace += getTime(start, end);
+    }
+
+  // Compare lower triangles of the two results
+  Matrix diff = termSolve - termInverse;
+  double maxDiff = diff.triangularView<Eigen::Lower>().toDenseMatrix().cwiseAbs().maxCoeff();
+  diff = termSolve - K;
+  maxDiff = std::max(maxDiff, diff.triangularView<Eigen::Lower>().toDenseMatrix().cwiseAbs().maxCoeff());
+  double maxTerm = termSolve.cwiseAbs().maxCoeff();
+
+  cout << std::fixed << std::setprecision(4);
+  cout << "\n[ Gradient term ]\n";
+  cout << "Column solves:  " << timeSolve/repeats << " s\n";
+  cout << "SPD inverse:    " << timeInverse/repeats << " s   (speed-up " << std::setprecision(2) << timeSolve/timeInverse << "x)\n";
+  cout << std::setprecision(4) << "In place:       " << timeInPlace/repeats << " s   (speed-up " << std::setprecision(2) << timeSolve/timeInPlace << "x)\n";
+  cout << std::scientific << "Max rel. diff:  " << maxDiff/maxTerm << endl;
+
+
+  //
+  //   [ Cholesky Factorization:  Eigen LLT vs. tiled task graph ]
+  //
+
+  int tileSizes[4] = { 128, 256, 384, 512 };
+  double timeLLT = 0.0;
+  double timeTiled[4] = {0.0};
+  GP::TaskGraph graphs[4];   // Reused between repeats, as in model evaluations
+  Matrix Lref, Ltile;
+  for ( auto r : boost::irange(0,repeats) )
+    {
+      (void)r;
+      kernel.computeCov(Lref, D, params, 1e-10);
+      Ltile = Lref;
+      time start = high_resolution_clock::now();
+      Eigen::LLT<Eigen::Ref<Matrix>> llt(Lref);
+      time end = high_resolution_clock::now();
+      timeLLT += getTime(start, end);
+
+      for ( auto t : boost::irange(0,4) )
+        {
+          kernel.computeCov(Ltile, D, params, 1e-10);
+          start = high_resolution_clock::now();
+          GP::tiledCholesky(Ltile, tileSizes[t], &graphs[t]);
+          end = high_resolution_clock::now();
+          timeTiled[t] += getTime(start, end);
+        }
+    }
+
+  diff = Lref - Ltile;
+  cout << std::fixed << std::setprecision(4);
+  cout << "\n[ Cholesky ]   (default tile size " << GP::defaultTileSize(obsCount, GP::threadPool().width()) << ")\n";
+  cout << "Eigen LLT:      " << timeLLT/repeats << " s\n";
+  for ( auto t : boost::irange(0,4) )
+    cout << "Tiled (" << std::setw(3) << tileSizes[t] << "):    " << timeTiled[t]/repeats << " s   (speed-up " << std::setprecision(2) << timeLLT/timeTiled[t] << "x)\n" << std::setprecision(4);
+  cout << std::scientific << "Max abs. diff:  " << diff.triangularView<Eigen::Lower>().toDenseMatrix().cwiseAbs().maxCoeff() << endl;
+
+
+  //
+  //   [ NLML Evaluations:  double vs. mixed precision ]
+  //
+
+  GP::GaussianProcess models[2];
+  GP::RBF kernels[2];
+  Vector logParams = params.array().log().matrix();
+  Vector grads[2] = { Vector(3), Vector(3) };
+  double values[2] = {0.0};
+  double timeEval[2] = {0.0};
+  for ( auto m : boost::irange(0,2) )
+    {
+      models[m].setObs(X, y);
+      models[m].setKernel(kernels[m]);
+      models[m].setMixedPrecision(m == 1);
+      values[m] = models[m](logParams, grads[m]);   // warm-up [ sizes workspace and caches distances ]
+      for ( auto r : boost::irange(0,repeats) )
+        {
+          (void)r;
+          models[m].clearEvalCache();   // time a full factorization and gradient, not a memoized result
+          time start = high_resolution_clock::now();
+          values[m] = models[m](logParams, grads[m]);
+          time end = high_resolution_clock::now();
+          timeEval[m] += getTime(start, end);
+        }
+    }
+
+  cout << std::fixed << std::setprecision(4);
+  cout << "\n[ NLML + gradient ]\n";
+  cout << "Double:         " << timeEval[0]/repeats << " s\n";
+  cout << "Mixed:          " << timeEval[1]/repeats << " s   (speed-up " << std::setprecision(2) << timeEval[0]/timeEval[1] << "x)\n";
+  cout << std::scientific << "Rel. diff (NLML, grad):  " << std::abs(values[0] - values[1])/std::abs(values[0]) << "  "
+       << (grads[0] - grads[1]).norm()/grads[0].norm() << endl;
+
+
+  //
+  //   [ Noise/Scaling Grid:  Cholesky vs. cached eigendecomposition ]
+  //
+
+  const int gridCount = 5;
+  GP::RBF gridKernel;
+  Vector lengthScale(1);  lengthScale << params(2);
+  gridKernel.setParams(lengthScale);
+  GP::GaussianProcess gridModel;
+  gridModel.setObs(X, y);
+  gridModel.setKernel(gridKernel);
+  Vector gridGrad(3);
+  double maxGridDiff = 0.0;
+  double timeGrid[2] = {0.0};
+  time start = high_resolution_clock::now();
+  double spectralValue = gridModel.computeNLML(params(0), params(1));   // eigendecomposition
+  time end = high_resolution_clock::now();
+  double timeSpectrum = getTime(start, end);
+  for ( auto i : boost::irange(0,gridCount) )
+    {
+      Vector gridParams = logParams;
+      gridParams(0) = std::log(0.01) + i*std::log(10.0)/2;
+      start = high_resolution_clock::now();
+      double cholValue = gridModel(gridParams, gridGrad);
+      end = high_resolution_clock::now();
+      timeGrid[0] += getTime(start, end);
+
+      start = high_resolution_clock::now();
+      spectralValue = gridModel.computeNLML(std::exp(gridParams(0)), params(1));
+      end = high_resolution_clock::now();
+      timeGrid[1] += getTime(start, end);
+      maxGridDiff = std::max(maxGridDiff, std::abs(cholValue - spectralValue)/std::abs(cholValue));
+    }
+
+  cout << std::fixed << std::setprecision(4);
+  cout << "\n[ Noise/scaling grid ]\n";
+  cout << "Eigendecomposition:  " << timeSpectrum << " s  (once)\n";
+  cout << "Cholesky:            " << timeGrid[0]/gridCount << " s  per point\n";
+  cout << std::scientific << std::setprecision(2) << "Spectral:            " << timeGrid[1]/gridCount << " s  per point\n";
+  cout << "Max rel. diff:       " << maxGridDiff << endl;
+
+
+  //
+  //   [ Hyperparameter Fits:  evaluations to converge and wall time of each optimizer ]
+  //
+
+  FitProblem problems[5] = { { "1D example   ", oscillatoryFunc, 1, 250, 1.0, 2 },
+                             { "1D low noise ", oscillatoryFunc, 1, 50, 0.1, 4 },
+                             { "2D example   ", marrWavelet, 2, obsCount, 1.0, 0 },
+                             { "2D multimodal", multiModalFunc, 2, obsCount, 1.0, 0 },
+                             { "1D noise only", noiseOnlyFunc, 1, 300, 1.0, 2 } };
+  GP::Optimizer optimizers[5] = { GP::Optimizer::LBFGS, GP::Optimizer::LBFGSB, GP::Optimizer::FisherScoring,
+                                  GP::Optimizer::ConjugateGradient, GP::Optimizer::CppOptLib };
+  cout << "\n[ Hyperparameter fits ]             evals  grads   info     time        NLML\n";
+  for ( auto & problem : problems )
+    {
+      for ( auto optimizer : optimizers )
+        {
+          cout << std::fixed << problem.name << "  " << std::left << std::setw(20) << GP::optimizerName(optimizer) << std::right;
+          if ( !GP::optimizerAvailable(optimizer) )
+            {
+              cout << "   not compiled in  ( make bench OPTLIB=cppoptlib )\n";
+              continue;
+            }
+          FitResult result = fitProblem(problem, [optimizer](GP::GaussianProcess & model) { model.setOptimizer(optimizer); });
+          cout << std::setw(6) << result.functionEvals << " " << std::setw(6) << result.gradientEvals << " " << std::setw(6) << result.fisherEvals
+               << "   " << std::setprecision(4) << result.time << " s   " << std::setprecision(6) << result.nlml << "\n";
+        }
+    }
+
+
+  //
+  //   [ Line Search Budget:  default line searches vs. the budgeted line search on the 2D fits ]
+  //
+
+  GP::Optimizer searchers[2] = { GP::Optimizer::LBFGSB, GP::Optimizer::ConjugateGradient };
+  int budgets[2] = { 0, 4 };
+  cout << "\n[ Line search budget ]                        evals  grads     time        NLML\n";
+  for ( auto p : boost::irange(2,4) )
+    {
+      for ( auto optimizer : searchers )
+        {
+          for ( auto budget : budgets )
+            {
+              FitResult result = fitProblem(problems[p], [optimizer, budget](GP::GaussianProcess & model) { model.setOptimizer(optimizer);
+                                                                                                               model.setLineSearchBudget(budget); });
+              std::string label = std::string(GP::optimizerName(optimizer)) + ( budget > 0 ? ", budget " + std::to_string(budget) : "" );
+              cout << std::fixed << problems[p].name << "  " << std::left << std::setw(30) << label << std::right
+                   << std::setw(6) << result.functionEvals << " " << std::setw(6) << result.gradientEvals << "   "
+                   << std::setprecision(4) << result.time << " s   " << std::setprecision(6) << result.nlml << "\n";
+            }
+        }
+    }
+
+
+  //
+  //   [ Linear Algebra Backends:  Eigen vs. LAPACKE ]
+  //
+
+  if ( !GP::backendAvailable(GP::Backend::Lapacke) )
+    {
+      cout << "\n[ Backends ]\nLAPACKE backend not compiled in  ( make bench BACKEND=lapacke )\n\n";
+      return 0;
+    }
+
+  // Time factorization, alpha solve, inverse and prediction solve for each backend
+  Matrix kstar = Matrix::Random(obsCount, 200);
+  Matrix L[2], B[2], V[2], Kinv[2];
+  double times[2][4] = {{0.0}};
+  GP::Backend backends[2] = { GP::Backend::Eigen, GP::Backend::Lapacke };
+  for ( auto r : boost::irange(0,repeats) )
+    {
+      (void)r;
+      for ( auto b : boost::irange(0,2) )
+        {
+          kernel.computeCov(L[b], D, params, 1e-10);
+          time start = high_resolution_clock::now();
+          GP::choleskyFactor(L[b], backends[b]);
+          time end = high_resolution_clock::now();
+          times[b][0] += getTime(start, end);
+
+          B[b] = y;
+          start = high_resolution_clock::now();
+          GP::choleskySolve(L[b], B[b], backends[b]);
+          end = high_resolution_clock::now();
+          times[b][1] += getTime(start, end);
+
+          start = high_resolution_clock::now();
+          GP::spdInverse(L[b], Kinv[b], 64, backends[b]);
+          end = high_resolution_clock::now();
+          times[b][2] += getTime(start, end);
+
+          V[b] = kstar;
+          start = high_resolution_clock::now();
+          GP::triangularSolve(L[b], V[b], backends[b]);
+          end = high_resolution_clock::now();
+          times[b][3] += getTime(start, end);
+        }
+    }
+
+  const char * labels[4] = { "Cholesky:        ", "Alpha solve:     ", "SPD inverse:     ", "Triangular solve:" };
+  cout << std::fixed << std::setprecision(4);
+  cout << "\n[ Backends ]             " << GP::backendName(GP::Backend::Eigen) << "      " << GP::backendName(GP::Backend::Lapacke) << "\n";
+  for ( auto k : boost::irange(0,4) )
+    cout << labels[k] << "       " << times[0][k]/repeats << " s   " << times[1][k]/repeats << " s\n";
+
+  Matrix diffL = L[0] - L[1];
+  Matrix diffInv = Kinv[0] - Kinv[1];
+  cout << std::scientific << "Max diff (L, alpha, K^-1, v):  "
+       << diffL.triangularView<Eigen::Lower>().toDenseMatrix().cwiseAbs().maxCoeff() << "  "
+       << (B[0] - B[1]).cwiseAbs().maxCoeff() / B[0].cwiseAbs().maxCoeff() << "  "
+       << diffInv.triangularView<Eigen::Lower>().toDenseMatrix().cwiseAbs().maxCoeff() / Kinv[0].cwiseAbs().maxCoeff() << "  "
+       << (V[0] - V[1]).cwiseAbs().maxCoeff() / V[0].cwiseAbs().maxCoeff() << endl << endl;
+
+  return 0;
+
+}
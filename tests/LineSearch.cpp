@@ -0,0 +1,145 @@
+// LineSearch.cpp -- checks the steps returned by the value-first and budgeted line searches
+//
+//   Every step returned with a budget of 2-4 trial points must decrease the objective and satisfy  s^T y > 0
+//   (i.e. dg > dg_init), since L-BFGS updates with s^T y <= 0 corrupt the two-loop recursion; line searches
+//   which cannot return such a step must throw instead
+//
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+#include <string>
+#include <functional>
+#include <stdexcept>
+#include <boost/range/irange.hpp>
+#include "../GPs.h"
+
+using Vector = Eigen::VectorXd;
+using Matrix = Eigen::MatrixXd;
+
+
+// Define a test objective from value and gradient functions
+class TestObjective : public GP::Objective
+{
+public:
+  TestObjective(std::function<double(const Vector &)> f, std::function<void(const Vector &, Vector &)> g) : f(f), g(g) { }
+  double value(const Vector & x) { return f(x); }
+  void gradient(const Vector & x, Vector & grad) { g(x, grad); }
+
+private:
+  std::function<double(const Vector &)> f;
+  std::function<void(const Vector &, Vector &)> g;
+};
+
+// Count the outcomes of the line searches
+struct Outcome { int returned = 0; int thrown = 0; int failed = 0; };
+
+// Run one line search from x along -grad(x) and check the returned step
+template <template <class> class LineSearch>
+void checkLineSearch(GP::Objective & objective, const Vector & xp, int budget, double step, Outcome & outcome)
+{
+  LBFGSpp::LBFGSParam<double> param;
+  param.max_linesearch = budget;
+  Vector grad(xp.size());
+  double fx = objective(xp, grad);
+  Vector drt = -grad;
+  double dg = grad.dot(drt);
+  const double fx_init = fx;
+  const double dg_init = dg;
+  Vector x = xp;
+  try
+    {
+      LineSearch<double>::LineSearch(objective, param, xp, drt, std::numeric_limits<double>::infinity(), step, fx, grad, dg, x);
+    }
+  catch ( const std::runtime_error & )
+    {
+      outcome.thrown += 1;
+      return;
+    }
+  outcome.returned += 1;
+
+  // The returned step must decrease the objective, and the returned gradient must belong to it with  s^T y > 0
+  Vector gradCheck(xp.size());
+  objective.gradient(x, gradCheck);
+  bool consistent = ( ( x - (xp + step*drt) ).norm() <= 1e-12 * ( 1.0 + xp.norm() ) ) && ( ( grad - gradCheck ).norm() <= 1e-10 * ( 1.0 + grad.norm() ) );
+  bool decrease = ( fx < fx_init );
+  bool curvature = ( dg > dg_init ) && ( step * ( dg - dg_init ) > 0 );
+  if ( !( consistent && decrease && curvature ) )
+    {
+      outcome.failed += 1;
+      std::cout << "   [ FAILED ]  step = " << step << "  fx = " << fx << " (" << fx_init << ")  dg = " << dg << " (" << dg_init << ")\n";
+    }
+}
+
+
+int main()
+{
+  // Rosenbrock function in 4 dimensions
+  auto rosenbrockValue = [](const Vector & x) {
+                           double f = 0.0;
+                           for ( auto i : boost::irange(0,static_cast<int>(x.size())-1) )
+                             f += 100.0*std::pow(x(i+1) - x(i)*x(i), 2) + std::pow(1.0 - x(i), 2);
+                           return f;
+                         };
+  auto rosenbrockGradient = [](const Vector & x, Vector & grad) {
+                              grad.setZero(x.size());
+                              for ( auto i : boost::irange(0,static_cast<int>(x.size())-1) )
+                                {
+                                  double r = x(i+1) - x(i)*x(i);
+                                  grad(i) += -400.0*r*x(i) - 2.0*(1.0 - x(i));
+                                  grad(i+1) += 200.0*r;
+                                }
+                            };
+  TestObjective rosenbrock(rosenbrockValue, rosenbrockGradient);
+
+  // Concave function  [ unbounded below, so that the slope keeps decreasing along every descent direction and no step gives s^T y > 0 ]
+  TestObjective concave([](const Vector & x) { return -x.sum() - x.squaredNorm(); },
+                        [](const Vector & x, Vector & grad) { grad = -Vector::Ones(x.size()) - 2.0*x; });
+
+  // Nearly linear function  [ the curvature condition is only met far beyond the first trial steps ]
+  TestObjective linear([](const Vector & x) { return -x.sum() + 1e-4*x.squaredNorm(); },
+                       [](const Vector & x, Vector & grad) { grad = -Vector::Ones(x.size()) + 2e-4*x; });
+
+  // Negative log marginal likelihood of the 1D example in tests/
+  std::srand(static_cast<unsigned int>(0));
+  Matrix X = GP::sampleUnif(-1.0, 1.0, 100, 1);
+  Matrix y(100, 1);
+  for ( auto i : boost::irange(0,100) )
+    y(i) = std::sin(15.0*(X(i) + 1.0)) * (0.5 - 0.5*X(i))*15.0 + 0.5*std::cos(37.0*i);
+  GP::RBF kernel;
+  GP::GaussianProcess model;
+  model.setObs(X, y);
+  model.setKernel(kernel);
+  model.setNoise(0.1);
+  model.fitModel();
+
+  std::vector<std::pair<std::string, GP::Objective *>> objectives = { { "Rosenbrock   ", &rosenbrock }, { "Concave      ", &concave },
+                                                                      { "Nearly linear", &linear }, { "GP NLML      ", &model } };
+  int failures = 0;
+  std::cout << "\n[ Line search checks ]                       returned   thrown   failed\n";
+  for ( auto & objective : objectives )
+    {
+      for ( auto budget : { 2, 3, 4 } )
+        {
+          Outcome valueFirst, budgeted;
+          std::mt19937 generator(budget);
+          std::uniform_real_distribution<double> uniform(-2.0, 2.0);
+          for ( auto trial : boost::irange(0,50) )
+            {
+              Vector xp = ( objective.second == &model ) ? Vector(Vector::NullaryExpr(2, [&]() { return 0.5*uniform(generator); }))
+                                                         : Vector(Vector::NullaryExpr(4, [&]() { return uniform(generator); }));
+              double step = std::pow(10.0, -3.0 + 6.0*trial/49.0);
+              checkLineSearch<GP::ValueFirstLineSearch>(*objective.second, xp, budget, step, valueFirst);
+              checkLineSearch<GP::BudgetLineSearch>(*objective.second, xp, budget, step, budgeted);
+            }
+          for ( auto & result : { std::make_pair("value-first", valueFirst), std::make_pair("budgeted   ", budgeted) } )
+            {
+              std::cout << objective.first << "  " << result.first << ", budget " << budget << "   " << std::setw(8) << result.second.returned
+                        << " " << std::setw(8) << result.second.thrown << " " << std::setw(8) << result.second.failed << "\n";
+              failures += result.second.failed;
+            }
+        }
+    }
+
+  std::cout << ( ( failures == 0 ) ? "\nAll returned steps satisfy s^T y > 0\n" : "\nSome returned steps violate s^T y > 0\n" );
+  return ( failures == 0 ) ? 0 : 1;
+}